@@ -35,19 +35,36 @@ RowLayout {
 
             signal mapClear()
             signal mapFetch()
+            signal mapUpdate()
             signal mapSave(string filename)
+            signal mapLoad(string filename)
+            signal mapScrub(string position)
+
+            property real historyDuration: 0
+            property real historyMemory: 0
+            property real historyMemoryPerHour: 0
 
             FileDialog {
                 id: saveFileDialog
                 fileMode: FileDialog.SaveFile
                 defaultSuffix: "png"
-                nameFilters: [ "Image files (*.png)", "All files (*)" ]
+                nameFilters: [ "Image files (*.png)", "Map snapshots (*.ctmap)", "All files (*)" ]
 
                 onAccepted: {
                     mapViewer.mapSave(saveFileDialog.selectedFile);
                 }
             }
 
+            FileDialog {
+                id: loadFileDialog
+                fileMode: FileDialog.OpenFile
+                nameFilters: [ "Map snapshots (*.ctmap)", "All files (*)" ]
+
+                onAccepted: {
+                    mapViewer.mapLoad(loadFileDialog.selectedFile);
+                }
+            }
+
             Label {
                 font.bold: true
                 font.styleName: "Bold"
@@ -66,6 +83,16 @@ RowLayout {
                 }
             }
 
+            Button {
+                text: "Update"
+                ToolTip.visible: hovered
+                ToolTip.text: "Fetch changed blocks only"
+
+                onClicked: {
+                    parent.mapUpdate();
+                }
+            }
+
             Button {
                 text: "Clear"
 
@@ -81,6 +108,66 @@ RowLayout {
                     saveFileDialog.open();
                 }
             }
+
+            Button {
+                text: "Load from file"
+                enabled: !map.snapshotBusy
+
+                onClicked: {
+                    loadFileDialog.open();
+                }
+            }
+
+            Item {
+                width: 40
+            }
+
+            Label {
+                text: "Zoom:"
+            }
+
+            Slider {
+                id: mapZoom
+                from: 0.125
+                to: 1.0
+                value: 1.0
+                implicitWidth: 150
+            }
+
+            Item {
+                width: 40
+            }
+
+            Label {
+                text: "History:"
+            }
+
+            Slider {
+                id: mapHistory
+                from: 0.0
+                to: 1.0
+                value: 1.0
+                implicitWidth: 200
+
+                onMoved: {
+                    parent.mapScrub(value.toString());
+                }
+            }
+
+            Button {
+                text: "Live"
+                enabled: mapHistory.value < 1.0
+
+                onClicked: {
+                    mapHistory.value = 1.0;
+                    parent.mapScrub("1");
+                }
+            }
+
+            Label {
+                text: (mapHistory.value < 1.0 ? "-" + ((1.0 - mapHistory.value) * parent.historyDuration).toFixed(0) + " s, " : "")
+                    + parent.historyMemory.toFixed(1) + " MB (" + parent.historyMemoryPerHour.toFixed(1) + " MB/h)"
+            }
         }
 
         Rectangle {
@@ -111,15 +198,25 @@ RowLayout {
                 MapImageItem {
                     id: map
                     objectName: "Map"
-                    width: 1536
-                    height: 1536
+                    property real zoom: mapZoom.value
+                    width: 1536 * zoom
+                    height: 1536 * zoom
                     rotation: 180
+                    visible: !mapSceneGraph
 
                     function scroll_to(x, y) {
-                        map_flickable.contentX = x - map_flickable.implicitWidth / 2;
-                        map_flickable.contentY = y - map_flickable.implicitHeight / 2;
+                        map_flickable.contentX = x * zoom - map_flickable.implicitWidth / 2;
+                        map_flickable.contentY = y * zoom - map_flickable.implicitHeight / 2;
                     }
                 }
+
+                MapSGItem {
+                    source: map
+                    width: map.width
+                    height: map.height
+                    rotation: map.rotation
+                    visible: mapSceneGraph
+                }
             }
 
             border.color: "#d5d8dc"
@@ -30,6 +30,10 @@ RowLayout {
         id: script_viewer
         objectName: "script_viewer"
 
+        property bool uploading: false
+        property real uploadProgress: 0
+        property int uploadWindow: script_window.value
+
         signal scriptLoad(string filename)
         signal scriptSave(string filename)
         signal scriptAbort()
@@ -86,6 +90,7 @@ RowLayout {
 
             Button {
                 text: "Send to bot"
+                enabled: !script_viewer.uploading
 
                 onClicked: {
                     script_viewer.scriptSend();
@@ -138,6 +143,25 @@ RowLayout {
             }
         }
 
+        RowLayout {
+            Label {
+                text: "Chunks per 75 ms:"
+            }
+
+            SpinBox {
+                id: script_window
+                from: 1
+                to: 16
+                value: 1
+                enabled: !script_viewer.uploading
+            }
+
+            ProgressBar {
+                value: script_viewer.uploadProgress
+                Layout.fillWidth: true
+            }
+        }
+
         Rectangle {
             ScrollView {
                 anchors.fill: parent
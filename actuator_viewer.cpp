@@ -34,27 +34,23 @@
 #include "command.h"
 
 
-ActuatorViewerV1::ActuatorViewerV1(QQmlApplicationEngine* p_engine, ConnectionManagerV1& command_eval) : ValueViewer { p_engine }, p_lcd_ {} {
+ActuatorViewerV1::ActuatorViewerV1(QQmlApplicationEngine* p_engine, ConnectionManagerV1& command_eval)
+    : ValueViewer { p_engine, command_eval }, p_lcd_ {} {
     qmlRegisterType<ValueModel>("Actuators", 1, 0, "ActuatorModel");
     qmlRegisterUncreatableType<ValueList>("Actuators", 1, 0, "ValueList", QStringLiteral("Actuators should not be created in QML"));
 
-    list_.appendItem(MOTOR_L_.cbegin());
-    list_.appendItem(MOTOR_R_.cbegin());
-    list_.appendItem(LEDS_.cbegin());
-
-    update_map();
+    append_slots(SLOT_NAMES_);
     register_model(QStringLiteral("actuatorModel"));
 
-    command_eval.register_cmd(ctbot::CommandCodes::CMD_AKT_MOT, [this](const ctbot::CommandBase& cmd) {
-        // std::cout << "CMD_AKT_MOT received: " << cmd << "\n";
-        model_.setData(map_[MOTOR_L_.cbegin()], cmd.get_cmd_data_l(), ValueModel::Value);
-        model_.setData(map_[MOTOR_R_.cbegin()], cmd.get_cmd_data_r(), ValueModel::Value);
+    /* motor and LED values are decoded by the I/O thread, the LCD is updated by the GUI thread */
+    command_eval.register_decoder(ctbot::CommandCodes::CMD_AKT_MOT, [this](const ctbot::CommandView& cmd, const int64_t timestamp) {
+        push_sample(SLOT_MOTOR_L, cmd.header.data_l, timestamp);
+        push_sample(SLOT_MOTOR_R, cmd.header.data_r, timestamp);
         return true;
     });
 
-    command_eval.register_cmd(ctbot::CommandCodes::CMD_AKT_LED, [this](const ctbot::CommandBase& cmd) {
-        // std::cout << "CMD_AKT_LED received: " << cmd << std::endl;
-        model_.setData(map_[LEDS_.cbegin()], cmd.get_cmd_data_l(), ValueModel::Value);
+    command_eval.register_decoder(ctbot::CommandCodes::CMD_AKT_LED, [this](const ctbot::CommandView& cmd, const int64_t timestamp) {
+        push_sample(SLOT_LEDS, cmd.header.data_l, timestamp);
         return true;
     });
 
@@ -146,45 +142,37 @@ ActuatorViewerV1::ActuatorViewerV1(QQmlApplicationEngine* p_engine, ConnectionMa
 }
 
 
-ActuatorViewerV2::ActuatorViewerV2(QQmlApplicationEngine* p_engine, ConnectionManagerV2& command_eval) : ValueViewer { p_engine } {
+ActuatorViewerV2::ActuatorViewerV2(QQmlApplicationEngine* p_engine, ConnectionManagerV2& command_eval) : ValueViewer { p_engine, command_eval } {
     qmlRegisterType<ValueModel>("Actuators", 1, 0, "ActuatorModel");
     qmlRegisterUncreatableType<ValueList>("Actuators", 1, 0, "ValueList", QStringLiteral("Actuators should not be created in QML"));
 
-    list_.appendItem(MOTOR_L_.cbegin());
-    list_.appendItem(MOTOR_R_.cbegin());
-    list_.appendItem(SERVO_1_.cbegin());
-    list_.appendItem(SERVO_2_.cbegin());
-    list_.appendItem(LEDS_.cbegin());
-
-    update_map();
+    append_slots(SLOT_NAMES_);
     register_model(QStringLiteral("actuatorModelV2"));
 
-    command_eval.register_cmd("act", [this, &command_eval](const std::string_view& str) {
-        if (command_eval.get_version() != command_eval.version_active()) {
-            return false;
-        }
-
+    /* decoded by the I/O thread, the connection is only established if version 2 is active */
+    command_eval.register_decoder("act", [this](const std::string_view& str, const int64_t timestamp) {
         if (!str.length()) {
-            return false;
+            return true;
         }
 
-        int16_t values[2];
-        if (parse(str, motor_regex_, values[0], values[1])) {
-            model_.setData(map_[MOTOR_L_.cbegin()], values[0], ValueModel::Value);
-            model_.setData(map_[MOTOR_R_.cbegin()], values[1], ValueModel::Value);
+        const auto fields { parser_.parse(str) };
+        if (fields.has(MOTOR_)) {
+            push_sample(SLOT_MOTOR_L, fields.get(MOTOR_, 0), timestamp);
+            push_sample(SLOT_MOTOR_R, fields.get(MOTOR_, 1), timestamp);
         }
 
-        if (parse(str, servo1_regex_, values[0])) {
-            model_.setData(map_[SERVO_1_.cbegin()], values[0], ValueModel::Value);
+        if (fields.has(SERVO1_)) {
+            push_sample(SLOT_SERVO_1, fields.get(SERVO1_), timestamp);
         }
 
-        if (parse(str, servo2_regex_, values[0])) {
-            model_.setData(map_[SERVO_2_.cbegin()], values[0], ValueModel::Value);
+        if (fields.has(SERVO2_)) {
+            push_sample(SLOT_SERVO_2, fields.get(SERVO2_), timestamp);
         }
 
-        if (parse(str, led_regex_, values[0])) {
-            model_.setData(map_[LEDS_.cbegin()], values[0], ValueModel::Value);
+        if (fields.has(LED_)) {
+            push_sample(SLOT_LEDS, fields.get(LED_), timestamp);
         }
+
         return true;
     });
 }
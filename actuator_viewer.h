@@ -25,11 +25,12 @@
 #pragma once
 
 #include "value_viewer.h"
+#include "field_parser.h"
 
 #include <QRegularExpression>
 
+#include <array>
 #include <string_view>
-#include <regex>
 
 
 class ConnectionManagerV1;
@@ -41,6 +42,19 @@ protected:
     static constexpr std::string_view MOTOR_R_ { "Motor right" };
     static constexpr std::string_view LEDS_ { "LEDs" };
 
+    enum Slot : int {
+        SLOT_MOTOR_L,
+        SLOT_MOTOR_R,
+        SLOT_LEDS,
+        NUM_SLOTS
+    };
+    static constexpr std::array SLOT_NAMES_ {
+        MOTOR_L_,
+        MOTOR_R_,
+        LEDS_,
+    };
+    static_assert(SLOT_NAMES_.size() == NUM_SLOTS);
+
     static inline const QRegularExpression regex_replace_0_ { "[\001-\007]" };
     static inline const QRegularExpression regex_replace_1_ { "[\016-\037]" };
     static inline const QRegularExpression regex_replace_2_ { "[\177-\377]" };
@@ -57,18 +71,37 @@ class ActuatorViewerV2 : public ValueViewer {
 protected:
     static constexpr std::string_view MOTOR_L_ { "Motor left [%]" };
     static constexpr std::string_view MOTOR_R_ { "Motor right [%]" };
-    static constexpr std::string_view MOTOR_RE_ { R"(motor: (-?\d*) (-?\d*))" };
     static constexpr std::string_view SERVO_1_ { "Servo 1" };
-    static constexpr std::string_view SERVO_1_RE_ { R"(servo1: (\d*))" };
     static constexpr std::string_view SERVO_2_ { "Servo 2" };
-    static constexpr std::string_view SERVO_2_RE_ { R"(servo2: (\d*))" };
     static constexpr std::string_view LEDS_ { "LEDs" };
-    static constexpr std::string_view LEDS_RE_ { R"(leds: (\d*))" };
 
-    static inline const std::regex motor_regex_ { MOTOR_RE_.cbegin() };
-    static inline const std::regex servo1_regex_ { SERVO_1_RE_.cbegin() };
-    static inline const std::regex servo2_regex_ { SERVO_2_RE_.cbegin() };
-    static inline const std::regex led_regex_ { LEDS_RE_.cbegin() };
+    enum Slot : int {
+        SLOT_MOTOR_L,
+        SLOT_MOTOR_R,
+        SLOT_SERVO_1,
+        SLOT_SERVO_2,
+        SLOT_LEDS,
+        NUM_SLOTS
+    };
+    static constexpr std::array SLOT_NAMES_ {
+        MOTOR_L_,
+        MOTOR_R_,
+        SERVO_1_,
+        SERVO_2_,
+        LEDS_,
+    };
+    static_assert(SLOT_NAMES_.size() == NUM_SLOTS);
+
+    static constexpr FieldParser parser_ { std::array {
+        FieldSpec { "motor", 2 },
+        FieldSpec { "servo1", 1 },
+        FieldSpec { "servo2", 1 },
+        FieldSpec { "leds", 1 },
+    } };
+    static constexpr size_t MOTOR_ { parser_.index("motor") };
+    static constexpr size_t SERVO1_ { parser_.index("servo1") };
+    static constexpr size_t SERVO2_ { parser_.index("servo2") };
+    static constexpr size_t LED_ { parser_.index("leds") };
 
 public:
     ActuatorViewerV2(QQmlApplicationEngine* p_engine, ConnectionManagerV2& command_eval);
@@ -0,0 +1,81 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    bench.h
+ * @brief   Minimal helpers for the benchmarks
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string_view>
+
+
+namespace bench {
+
+/**
+ * @brief Run a function several times and return the fastest run
+ * @param[in] func: Function to measure, called once per run
+ * @param[in] runs: Number of runs
+ * @return Duration of fastest run in ns
+ */
+template <typename F>
+double measure_ns(F&& func, const size_t runs = 5) {
+    double best {};
+    for (size_t i {}; i < runs; ++i) {
+        const auto start { std::chrono::steady_clock::now() };
+        func();
+        const std::chrono::duration<double, std::nano> duration { std::chrono::steady_clock::now() - start };
+        best = i ? std::min(best, duration.count()) : duration.count();
+    }
+
+    return best;
+}
+
+/**
+ * @brief Keep the compiler from optimizing away a result
+ */
+template <typename T>
+void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * @brief Print one result line
+ * @param[in] name: Name of the measured case
+ * @param[in] ns: Duration of one run in ns
+ * @param[in] items: Number of items processed per run
+ * @param[in] unit: Name of an item
+ * @param[in] bytes: Number of bytes processed per run, 0 to omit the throughput
+ */
+inline void report(const std::string_view& name, const double ns, const size_t items, const std::string_view& unit, const size_t bytes = 0) {
+    std::printf("%-40.*s %10.1f ns/%.*s %12.0f %.*s/s", static_cast<int>(name.size()), name.data(), ns / static_cast<double>(items),
+        static_cast<int>(unit.size()), unit.data(), static_cast<double>(items) * 1e9 / ns, static_cast<int>(unit.size()), unit.data());
+    if (bytes) {
+        std::printf(" %8.1f MB/s", static_cast<double>(bytes) * 1e3 / ns);
+    }
+    std::printf("\n");
+}
+
+} /* namespace bench */
@@ -0,0 +1,139 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    crc16_bench.cpp
+ * @brief   Cost of the CRC16 policy compared to CRCNoCheck
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#include <array>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "command.h"
+#include "crc16.h"
+
+
+namespace {
+
+constexpr size_t BLOCKS { 100'000 };
+constexpr size_t FRAMES { 100'000 };
+constexpr std::array<size_t, 3> SIZES { sizeof(ctbot::CommandData), sizeof(ctbot::CommandData) + 128, sizeof(ctbot::CommandData) + 255 };
+
+/**
+ * @brief Bytewise CRC-16/MCRF4XX as _crc_ccitt_update() of avr-libc, reference for crc16_update()
+ */
+uint16_t crc16_bitwise(const void* data, const size_t len, uint16_t crc = ctbot::CRC16_INIT) {
+    auto ptr { static_cast<const uint8_t*>(data) };
+    for (size_t i {}; i < len; ++i) {
+        uint8_t tmp { static_cast<uint8_t>(ptr[i] ^ (crc & 0xff)) };
+        tmp ^= static_cast<uint8_t>(tmp << 4);
+        crc = static_cast<uint16_t>(((static_cast<uint16_t>(tmp) << 8) | (crc >> 8)) ^ (tmp >> 4) ^ (static_cast<uint16_t>(tmp) << 3));
+    }
+
+    return crc;
+}
+
+/**
+ * @brief Frames with CRC, every 16th one with 128 bytes payload
+ */
+std::string create_stream() {
+    std::string stream;
+    std::vector<uint8_t> payload(128);
+    for (size_t i {}; i < FRAMES; ++i) {
+        ctbot::CommandCRC cmd { ctbot::CommandCodes::CMD_SENS_IR, ctbot::CommandCodes::CMD_SUB_NORM, static_cast<int16_t>(i), static_cast<int16_t>(-i) };
+        if (i % 16 == 15) {
+            std::fill(payload.begin(), payload.end(), static_cast<uint8_t>(i));
+            cmd.add_payload(payload.data(), payload.size());
+        }
+        stream.append(reinterpret_cast<const char*>(&cmd.get_cmd()), sizeof(ctbot::CommandData));
+        stream.append(reinterpret_cast<const char*>(cmd.get_payload().data()), cmd.get_payload_size());
+    }
+
+    return stream;
+}
+
+template <class CRCPolicy>
+size_t parse(const std::string_view& stream) {
+    size_t frames {};
+    std::string_view buf { stream };
+    while (!buf.empty()) {
+        ctbot::CommandView cmd;
+        size_t consumed {};
+        const auto status { ctbot::Command<CRCPolicy>::try_parse(buf, cmd, consumed) };
+        if (status == ctbot::ParseStatus::NEED_MORE_DATA) {
+            break;
+        }
+        if (status == ctbot::ParseStatus::OK) {
+            bench::do_not_optimize(cmd);
+            ++frames;
+        }
+        buf.remove_prefix(consumed);
+    }
+
+    return frames;
+}
+
+} /* anonymous namespace */
+
+int main() {
+    std::vector<uint8_t> data(SIZES.back());
+    for (size_t i {}; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(i * 7 + 3);
+    }
+
+    for (const auto size : SIZES) {
+        if (ctbot::crc16_update(data.data(), size) != crc16_bitwise(data.data(), size)) {
+            std::printf("crc16_update() differs from reference for %zu bytes\n", size);
+            return 1;
+        }
+
+        uint16_t crc {};
+        auto ns { bench::measure_ns([&]() {
+            for (size_t i {}; i < BLOCKS; ++i) {
+                crc = ctbot::crc16_update(data.data(), size, crc);
+            }
+        }) };
+        bench::do_not_optimize(crc);
+        bench::report("crc16_update(), " + std::to_string(size) + " bytes", ns, BLOCKS, "block", BLOCKS * size);
+
+        ns = bench::measure_ns([&]() {
+            for (size_t i {}; i < BLOCKS; ++i) {
+                crc = crc16_bitwise(data.data(), size, crc);
+            }
+        });
+        bench::do_not_optimize(crc);
+        bench::report("bytewise reference, " + std::to_string(size) + " bytes", ns, BLOCKS, "block", BLOCKS * size);
+    }
+
+    const auto stream { create_stream() };
+    for (const bool check : { false, true }) {
+        size_t frames {};
+        const auto ns { bench::measure_ns([&]() { frames = check ? parse<ctbot::CRC16>(stream) : parse<ctbot::CRCNoCheck>(stream); }) };
+        if (frames != FRAMES) {
+            std::printf("parsed %zu of %zu frames\n", frames, FRAMES);
+            return 1;
+        }
+        bench::report(check ? "try_parse(), CRC16" : "try_parse(), CRCNoCheck", ns, FRAMES, "frame", stream.size());
+    }
+
+    return 0;
+}
@@ -0,0 +1,113 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    decoder_bench.cpp
+ * @brief   Throughput of the incremental V1 frame decoder on fragmented streams
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "bench.h"
+#include "command.h"
+#include "receive_buffer.h"
+
+
+namespace {
+
+constexpr size_t FRAMES { 100'000 };
+constexpr size_t BUFFER_SIZE { 64 * 1024 }; // as ConnectionManagerV1
+constexpr std::array<size_t, 5> CHUNK_SIZES { 1, 7, 64, 1'460, 16'384 }; // 1'460: TCP segment
+
+/**
+ * @brief Telemetry as sent by a bot: mostly sensor frames without payload, every 16th frame a map quarter with 128 bytes payload
+ */
+std::string create_stream() {
+    std::string stream;
+    for (size_t i {}; i < FRAMES; ++i) {
+        const bool map { i % 16 == 15 };
+        ctbot::CommandData header { map ? ctbot::CommandCodes::CMD_MAP : ctbot::CommandCodes::CMD_SENS_IR,
+            map ? ctbot::CommandCodes::CMD_SUB_MAP_DATA_1 : ctbot::CommandCodes::CMD_SUB_NORM, static_cast<int16_t>(i), static_cast<int16_t>(-i) };
+        header.payload = map ? 128 : 0;
+        header.seq = static_cast<uint8_t>(i);
+        stream.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        stream.append(header.payload, static_cast<char>(i));
+    }
+
+    return stream;
+}
+
+/**
+ * @brief Feed the stream in chunks into a ReceiveBuffer and decode it like ConnectionManagerV1 does
+ * @return Number of decoded frames
+ */
+size_t decode(const std::string& stream, const size_t chunk_size, ReceiveBuffer& buffer) {
+    size_t frames {};
+    size_t pos {};
+    buffer.clear();
+    while (pos < stream.size()) {
+        /* one socket read */
+        const auto n { std::min({ chunk_size, stream.size() - pos, buffer.writable() }) };
+        std::memcpy(buffer.prepare(), stream.data() + pos, n);
+        buffer.commit(n);
+        pos += n;
+
+        while (true) {
+            ctbot::CommandView cmd;
+            size_t consumed {};
+            const auto status { ctbot::CommandNoCRC::try_parse(buffer.view(), cmd, consumed) };
+            if (status == ctbot::ParseStatus::NEED_MORE_DATA) {
+                break;
+            }
+            if (status == ctbot::ParseStatus::OK) {
+                bench::do_not_optimize(cmd);
+                ++frames;
+            }
+            buffer.consume(consumed);
+        }
+    }
+
+    return frames;
+}
+
+} /* anonymous namespace */
+
+int main() {
+    const auto stream { create_stream() };
+    ReceiveBuffer buffer { BUFFER_SIZE };
+
+    std::printf("%zu frames, %zu bytes\n", FRAMES, stream.size());
+    for (const auto chunk : CHUNK_SIZES) {
+        size_t frames {};
+        const auto ns { bench::measure_ns([&]() { frames = decode(stream, chunk, buffer); }) };
+        if (frames != FRAMES) {
+            std::printf("decoded %zu of %zu frames\n", frames, FRAMES);
+            return 1;
+        }
+
+        const std::string name { "decode, " + std::to_string(chunk) + " byte chunks" };
+        bench::report(name, ns, FRAMES, "frame", stream.size());
+    }
+
+    return 0;
+}
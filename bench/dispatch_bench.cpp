@@ -0,0 +1,124 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    dispatch_bench.cpp
+ * @brief   Dispatch cost per frame of CommandDispatcher compared to the former std::map lookup
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#include <array>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+#include "bench.h"
+#include "command.h"
+#include "command_dispatcher.h"
+
+
+namespace {
+
+using ctbot::CommandCodes;
+
+constexpr size_t FRAMES { 100'000 };
+constexpr double FRAME_RATE { 10'000. }; // frames/s of a busy connection
+
+/**
+ * @brief Codes with handlers, as registered by the viewers
+ */
+constexpr std::array REGISTERED { CommandCodes::CMD_WELCOME, CommandCodes::CMD_DONE, CommandCodes::CMD_SHUTDOWN, CommandCodes::CMD_SENS_IR,
+    CommandCodes::CMD_SENS_ENC, CommandCodes::CMD_SENS_BORDER, CommandCodes::CMD_SENS_LINE, CommandCodes::CMD_SENS_LDR, CommandCodes::CMD_AKT_MOT,
+    CommandCodes::CMD_AKT_LED, CommandCodes::CMD_AKT_LCD, CommandCodes::CMD_LOG, CommandCodes::CMD_MAP, CommandCodes::CMD_REMOTE_CALL };
+
+/**
+ * @brief Codes of received frames, every 16th frame has no handler
+ */
+constexpr std::array RECEIVED { CommandCodes::CMD_SENS_IR, CommandCodes::CMD_SENS_ENC, CommandCodes::CMD_SENS_BORDER, CommandCodes::CMD_SENS_LINE,
+    CommandCodes::CMD_SENS_LDR, CommandCodes::CMD_AKT_MOT, CommandCodes::CMD_AKT_LED, CommandCodes::CMD_AKT_LCD, CommandCodes::CMD_LOG,
+    CommandCodes::CMD_MAP, CommandCodes::CMD_SENS_IR, CommandCodes::CMD_SENS_ENC, CommandCodes::CMD_AKT_MOT, CommandCodes::CMD_DONE,
+    CommandCodes::CMD_SENS_LINE, CommandCodes::CMD_SENS_MOUSE };
+
+/**
+ * @brief Lookup as done by ConnectionManagerV1 before the flat table, without the debug output for unregistered codes
+ */
+class MapDispatcher {
+    std::map<CommandCodes, std::vector<ctbot::CommandDispatcher::Handler>> commands_;
+
+public:
+    void add(const CommandCodes& cmd, ctbot::CommandDispatcher::Handler&& func) {
+        commands_[cmd].emplace_back(std::move(func));
+    }
+
+    bool dispatch(const ctbot::CommandBase& cmd, bool& result) const {
+        try {
+            result = true;
+            for (auto& func : commands_.at(cmd.get_cmd_code())) {
+                result &= func(cmd);
+            }
+            return true;
+        } catch (const std::out_of_range&) {
+            return false;
+        }
+    }
+};
+
+template <class Dispatcher>
+void run(const char* name, const std::vector<ctbot::CommandNoCRC>& frames) {
+    Dispatcher dispatcher;
+    int64_t sum {};
+    for (const auto code : REGISTERED) {
+        dispatcher.add(code, [&sum](const ctbot::CommandBase& cmd) {
+            sum += cmd.get_cmd_data_l();
+            return true;
+        });
+    }
+
+    size_t unregistered {};
+    const auto ns { bench::measure_ns([&]() {
+        unregistered = 0;
+        for (const auto& cmd : frames) {
+            bool result;
+            if (!dispatcher.dispatch(cmd, result)) {
+                ++unregistered;
+            }
+        }
+    }) };
+    bench::do_not_optimize(sum);
+
+    bench::report(name, ns, frames.size(), "frame");
+    std::printf("%-40s %10.4f %% of one core at %.0f frames/s, %zu unregistered\n", "", ns / static_cast<double>(frames.size()) * FRAME_RATE / 1e7,
+        FRAME_RATE, unregistered);
+}
+
+} /* anonymous namespace */
+
+int main() {
+    std::vector<ctbot::CommandNoCRC> frames;
+    frames.reserve(FRAMES);
+    for (size_t i {}; i < FRAMES; ++i) {
+        frames.emplace_back(RECEIVED[i % RECEIVED.size()], CommandCodes::CMD_SUB_NORM, static_cast<int16_t>(i), 0);
+    }
+
+    run<ctbot::CommandDispatcher>("CommandDispatcher", frames);
+    run<MapDispatcher>("std::map::at()", frames);
+
+    return 0;
+}
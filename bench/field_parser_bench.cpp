@@ -0,0 +1,170 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    field_parser_bench.cpp
+ * @brief   Lines/s of FieldParser compared to the former std::regex parsing of "sens" lines
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#include <array>
+#include <charconv>
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "bench.h"
+#include "field_parser.h"
+
+
+namespace {
+
+constexpr size_t LINES { 20'000 };
+
+/**
+ * @brief Field table of SensorViewerV2
+ */
+constexpr FieldParser parser { std::array {
+    FieldSpec { "enc", 2 },
+    FieldSpec { "dist", 2 },
+    FieldSpec { "line", 2 },
+    FieldSpec { "border", 2 },
+    FieldSpec { "trans", 2 },
+    FieldSpec { "rc5", 2 },
+    FieldSpec { "currents", 2 },
+    FieldSpec { "mcurrent", 1 },
+    FieldSpec { "bat", 2, FieldType::FLOAT },
+} };
+
+/**
+ * @brief Regular expressions of SensorViewerV2 before FieldParser, number of values per expression
+ */
+const std::array<std::tuple<std::regex, size_t, bool>, 9> regexes {
+    std::tuple { std::regex { R"(enc: (-?\d*) (-?\d*))" }, 2, false },
+    std::tuple { std::regex { R"(dist: (\d*) (\d*))" }, 2, false },
+    std::tuple { std::regex { R"(line: (\d*) (\d*))" }, 2, false },
+    std::tuple { std::regex { R"(border: (\d*) (\d*))" }, 2, false },
+    std::tuple { std::regex { R"(trans: (\d*) (\d*))" }, 2, false },
+    std::tuple { std::regex { R"(rc5: (\d*) (\d*) (?:\d*))" }, 2, false },
+    std::tuple { std::regex { R"(currents: (\d*) (\d*))" }, 2, false },
+    std::tuple { std::regex { R"(mcurrent: (\d*))" }, 1, false },
+    std::tuple { std::regex { R"(bat: (\d*\.\d*) (\d*\.\d*))" }, 2, true },
+};
+
+/**
+ * @brief "sens" lines as sent by a driving bot, values change from line to line
+ */
+std::vector<std::string> create_lines() {
+    std::vector<std::string> lines;
+    for (size_t i {}; i < LINES; ++i) {
+        const int n { static_cast<int>(i) };
+        char line[256];
+        std::snprintf(line, sizeof(line),
+            "enc: %d %d dist: %d %d line: %d %d border: %d %d trans: %d %d rc5: %d %d %d currents: %d %d mcurrent: %d bat: %d.%02d %d.%02d", n % 400 - 200,
+            n % 380 - 190, 100 + n % 900, 120 + n % 850, n % 1024, 1023 - n % 1024, n % 7, n % 5, n % 2, n % 80, n % 3, n % 64, n % 2, 100 + n % 50,
+            40 + n % 20, 200 + n % 300, 7, n % 100, 3, n % 100);
+        lines.emplace_back(line);
+    }
+
+    return lines;
+}
+
+/**
+ * @brief Parsing as done by SensorViewerV2 and ValueViewer::parse() before FieldParser: one regex_search per field, values copied to a
+ * std::string each, floats parsed with strtof() in the "C" locale
+ */
+float parse_regex(const std::string_view& str) {
+    float sum {};
+    for (const auto& [regex, count, is_float] : regexes) {
+        std::match_results<std::string_view::const_iterator> matches;
+        if (!std::regex_search(str.cbegin(), str.cend(), matches, regex)) {
+            continue;
+        }
+
+        if (is_float) {
+            const char* old_locale { std::setlocale(LC_ALL, nullptr) };
+            std::setlocale(LC_ALL, "C");
+            for (size_t i {}; i < count; ++i) {
+                sum += std::strtof(matches[i + 1].str().c_str(), nullptr);
+            }
+            std::setlocale(LC_ALL, old_locale);
+        } else {
+            for (size_t i {}; i < count; ++i) {
+                int16_t value {};
+                std::from_chars(matches[i + 1].str().c_str(), matches[i + 1].str().c_str() + matches[i + 1].str().size(), value);
+                sum += value;
+            }
+        }
+    }
+
+    return sum;
+}
+
+float parse_fields(const std::string_view& str) {
+    const auto fields { parser.parse(str) };
+    float sum {};
+    for (size_t i {}; i < regexes.size(); ++i) {
+        if (fields.has(i)) {
+            for (size_t n {}; n < std::get<1>(regexes[i]); ++n) {
+                sum += fields.get(i, n);
+            }
+        }
+    }
+
+    return sum;
+}
+
+} /* anonymous namespace */
+
+int main() {
+    const auto lines { create_lines() };
+    size_t bytes {};
+    for (const auto& line : lines) {
+        bytes += line.size();
+        if (std::abs(parse_regex(line) - parse_fields(line)) > 1e-2f) {
+            std::printf("results differ for \"%s\"\n", line.c_str());
+            return 1;
+        }
+    }
+
+    float sum {};
+    auto ns { bench::measure_ns([&]() {
+        for (const auto& line : lines) {
+            sum += parse_fields(line);
+        }
+    }) };
+    bench::report("FieldParser", ns, lines.size(), "line", bytes);
+
+    ns = bench::measure_ns(
+        [&]() {
+            for (const auto& line : lines) {
+                sum += parse_regex(line);
+            }
+        },
+        1);
+    bench::report("std::regex per field", ns, lines.size(), "line", bytes);
+    bench::do_not_optimize(sum);
+
+    return 0;
+}
@@ -0,0 +1,140 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    float_parse_bench.cpp
+ * @brief   Locale-independent parse_float() compared to strtof() with setlocale() on the battery values of "sens" lines
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#include <array>
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "bench.h"
+#include "field_parser.h"
+
+
+namespace {
+
+constexpr size_t LINES { 20'000 };
+
+const std::regex bat_regex { R"(bat: (\d*\.\d*) (\d*\.\d*))" };
+
+constexpr FieldParser bat_parser { std::array {
+    FieldSpec { "bat", 2, FieldType::FLOAT },
+} };
+
+/**
+ * @brief Tails of "sens" lines with the battery voltage and the voltage per cell
+ */
+std::vector<std::string> create_lines() {
+    std::vector<std::string> lines;
+    for (size_t i {}; i < LINES; ++i) {
+        const int n { static_cast<int>(i) };
+        char line[64];
+        std::snprintf(line, sizeof(line), "mcurrent: %d bat: %d.%03d %d.%03d", 200 + n % 300, 6 + n % 3, n % 1000, 3 + n % 2, (n * 7) % 1000);
+        lines.emplace_back(line);
+    }
+
+    return lines;
+}
+
+/**
+ * @brief Battery values as parsed by ValueViewer::parse() before: regex_search, a std::string per value, strtof() in the "C" locale
+ */
+float parse_setlocale(const std::string_view& str) {
+    std::match_results<std::string_view::const_iterator> matches;
+    if (!std::regex_search(str.cbegin(), str.cend(), matches, bat_regex)) {
+        return 0.f;
+    }
+
+    const char* old_locale { std::setlocale(LC_ALL, nullptr) };
+    std::setlocale(LC_ALL, "C");
+    const float value1 { std::strtof(matches[1].str().c_str(), nullptr) };
+    const float value2 { std::strtof(matches[2].str().c_str(), nullptr) };
+    std::setlocale(LC_ALL, old_locale);
+
+    return value1 + value2;
+}
+
+/**
+ * @brief Same regex, values parsed in place with parse_float()
+ */
+float parse_in_place(const std::string_view& str) {
+    std::match_results<std::string_view::const_iterator> matches;
+    if (!std::regex_search(str.cbegin(), str.cend(), matches, bat_regex)) {
+        return 0.f;
+    }
+
+    float value1 {}, value2 {};
+    const auto p_begin1 { str.data() + matches.position(1) };
+    const auto p_begin2 { str.data() + matches.position(2) };
+    parse_float(p_begin1, p_begin1 + matches.length(1), value1);
+    parse_float(p_begin2, p_begin2 + matches.length(2), value2);
+
+    return value1 + value2;
+}
+
+/**
+ * @brief Battery field as parsed by SensorViewerV2 now
+ */
+float parse_fields(const std::string_view& str) {
+    const auto fields { bat_parser.parse(str) };
+
+    return fields.has(0) ? fields.get(0, 0) + fields.get(0, 1) : 0.f;
+}
+
+template <typename F>
+void run(const char* name, const std::vector<std::string>& lines, F&& func, const size_t runs = 5) {
+    float sum {};
+    const auto ns { bench::measure_ns(
+        [&]() {
+            for (const auto& line : lines) {
+                sum += func(line);
+            }
+        },
+        runs) };
+    bench::do_not_optimize(sum);
+    bench::report(name, ns, lines.size(), "line");
+}
+
+} /* anonymous namespace */
+
+int main() {
+    const auto lines { create_lines() };
+    for (const auto& line : lines) {
+        const auto expected { parse_setlocale(line) };
+        if (std::abs(parse_in_place(line) - expected) > 1e-4f || std::abs(parse_fields(line) - expected) > 1e-4f) {
+            std::printf("results differ for \"%s\"\n", line.c_str());
+            return 1;
+        }
+    }
+
+    run("bat_regex_, strtof() + setlocale()", lines, parse_setlocale, 1);
+    run("bat_regex_, parse_float()", lines, parse_in_place, 1);
+    run("FieldParser, parse_float()", lines, parse_fields);
+
+    return 0;
+}
@@ -0,0 +1,170 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    map_replay_bench.cpp
+ * @brief   Replay of a full CMD_SUB_MAP_DATA_1..4 map transfer into the map image
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#include <QImage>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include "bench.h"
+#include "command.h"
+#include "map_block_assembler.h"
+#include "map_block_codec.h"
+
+
+namespace {
+
+using ctbot::MapBlockCodec;
+
+constexpr size_t MAP_PIXEL_SIZE { 1'536 }; // as MapImageItem
+constexpr size_t MAP_MACROBLOCK_SIZE { 512 };
+constexpr size_t MAP_BLOCKS { MAP_PIXEL_SIZE * MAP_PIXEL_SIZE / MapBlockCodec::BLOCK_SIZE_ };
+constexpr size_t SECTION_SIZE { MapBlockCodec::ROW_SIZE_ };
+constexpr size_t ROWS { MapBlockCodec::BLOCK_SIZE_ / SECTION_SIZE };
+
+/**
+ * @brief Stream of CMD_MAP frames as sent by the bot after CMD_SUB_MAP_REQUEST, four quarters per block
+ */
+std::string create_transfer() {
+    std::string stream;
+    uint8_t payload[MapBlockCodec::QUARTER_SIZE_];
+    for (size_t block {}; block < MAP_BLOCKS; ++block) {
+        for (size_t quarter {}; quarter < 4; ++quarter) {
+            for (size_t i {}; i < sizeof(payload); ++i) {
+                payload[i] = static_cast<uint8_t>((block * 31 + quarter * 7 + i) % 256);
+            }
+            ctbot::CommandData header { ctbot::CommandCodes::CMD_MAP,
+                static_cast<ctbot::CommandCodes>(static_cast<uint8_t>(ctbot::CommandCodes::CMD_SUB_MAP_DATA_1) + quarter), static_cast<int16_t>(block),
+                0 };
+            header.payload = sizeof(payload);
+            stream.append(reinterpret_cast<const char*>(&header), sizeof(header));
+            stream.append(reinterpret_cast<const char*>(payload), sizeof(payload));
+        }
+    }
+
+    return stream;
+}
+
+/**
+ * @brief Position of a block in the map image, as calculated by MapImageItem::update_map()
+ */
+void block_position(const size_t block, size_t& x, size_t& y) {
+    x = ((block * (SECTION_SIZE * 2)) % MAP_MACROBLOCK_SIZE + (block / MAP_MACROBLOCK_SIZE) * MAP_MACROBLOCK_SIZE) % MAP_PIXEL_SIZE;
+    y = (((block / SECTION_SIZE) * SECTION_SIZE) % MAP_MACROBLOCK_SIZE) + (block / MAP_PIXEL_SIZE) * MAP_MACROBLOCK_SIZE;
+}
+
+/**
+ * @brief Rows copied at once, as done by MapImageItem::update_map()
+ */
+void update_rows(QImage& image, const uint8_t* data, const size_t block) {
+    size_t x, y;
+    block_position(block, x, y);
+    const auto bytes_per_line { static_cast<size_t>(image.bytesPerLine()) };
+    MapBlockCodec::copy_rows(data, image.bits() + x * bytes_per_line + y, bytes_per_line, ROWS);
+}
+
+/**
+ * @brief One QImage::setPixel() per cell, as done by MapImageItem::update_map() before
+ */
+void update_pixels(QImage& image, const uint8_t* data, const size_t block) {
+    size_t x, y;
+    block_position(block, x, y);
+    size_t index {};
+    for (size_t j {}; j < ROWS; ++j) {
+        for (size_t i {}; i < SECTION_SIZE; ++i) {
+            const auto value { static_cast<int>(static_cast<int8_t>(data[index++])) + 128 };
+            image.setPixel(static_cast<int>(y + i), static_cast<int>(x + j), static_cast<unsigned>(value));
+        }
+    }
+}
+
+/**
+ * @brief Decode the transfer, reassemble its blocks and write them to the image
+ * @return Number of blocks written
+ */
+template <typename F>
+size_t replay(const std::string_view& transfer, QImage& image, F&& update) {
+    MapBlockAssembler assembler;
+    size_t blocks {};
+    std::string_view buf { transfer };
+    while (!buf.empty()) {
+        ctbot::CommandView cmd;
+        size_t consumed {};
+        if (ctbot::CommandNoCRC::try_parse(buf, cmd, consumed) == ctbot::ParseStatus::OK) {
+            const auto block { static_cast<uint16_t>(cmd.header.data_l) };
+            const size_t quarter { static_cast<size_t>(cmd.header.subcommand - static_cast<uint8_t>(ctbot::CommandCodes::CMD_SUB_MAP_DATA_1)) };
+            const auto p_block { assembler.add(block, quarter, reinterpret_cast<const uint8_t*>(cmd.payload.data()), 0) };
+            if (p_block) {
+                update(image, p_block->data(), block);
+                ++blocks;
+            }
+        }
+        buf.remove_prefix(consumed);
+    }
+
+    return blocks;
+}
+
+QImage create_image() {
+    QImage image { MAP_PIXEL_SIZE, MAP_PIXEL_SIZE, QImage::Format_Indexed8 };
+    QVector<QRgb> table;
+    for (int i {}; i < 256; ++i) {
+        table.push_back(qRgb(i, i, i));
+    }
+    image.setColorTable(table);
+    image.fill(128);
+
+    return image;
+}
+
+} /* anonymous namespace */
+
+int main() {
+    const auto transfer { create_transfer() };
+    auto image_rows { create_image() };
+    auto image_pixels { create_image() };
+
+    std::printf("%zu blocks, %zu bytes\n", MAP_BLOCKS, transfer.size());
+    for (const bool rows : { true, false }) {
+        auto& image { rows ? image_rows : image_pixels };
+        size_t blocks {};
+        const auto ns { bench::measure_ns([&]() { blocks = rows ? replay(transfer, image, update_rows) : replay(transfer, image, update_pixels); }) };
+        if (blocks != MAP_BLOCKS) {
+            std::printf("replayed %zu of %zu blocks\n", blocks, MAP_BLOCKS);
+            return 1;
+        }
+
+        bench::report(rows ? "row copy" : "QImage::setPixel()", ns, MAP_BLOCKS, "block", transfer.size());
+        std::printf("%-40s %10.2f ms per map\n", "", ns / 1e6);
+    }
+
+    if (image_rows != image_pixels) {
+        std::printf("images differ\n");
+        return 1;
+    }
+
+    return 0;
+}
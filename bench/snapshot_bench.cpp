@@ -0,0 +1,125 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    snapshot_bench.cpp
+ * @brief   Save and load time and file size of map snapshots compared to the PNG export of the whole map
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "bench.h"
+#include "map_snapshot.h"
+
+
+namespace {
+
+constexpr int MAP_PIXEL_SIZE { 1'536 }; // as MapImageItem
+constexpr int EXPLORED_SIZE { 512 }; /**< edge length of the explored area around the center */
+
+/**
+ * @brief Map with an explored square in the center: free space with some obstacles, unexplored cells elsewhere
+ */
+QImage create_map() {
+    QImage image { MAP_PIXEL_SIZE, MAP_PIXEL_SIZE, QImage::Format_Indexed8 };
+    QVector<QRgb> table;
+    for (int i {}; i < 256; ++i) {
+        table.push_back(qRgb(i, i, i));
+    }
+    image.setColorTable(table);
+    image.fill(MapSnapshot::UNKNOWN_);
+
+    const int first { (MAP_PIXEL_SIZE - EXPLORED_SIZE) / 2 };
+    for (int y { first }; y < first + EXPLORED_SIZE; ++y) {
+        const auto p_line { image.scanLine(y) };
+        for (int x { first }; x < first + EXPLORED_SIZE; ++x) {
+            const bool obstacle { (x / 16 + y / 24) % 11 == 0 };
+            p_line[x] = static_cast<uint8_t>(obstacle ? 20 : 200 + (x * 7 + y * 3) % 40 / 8);
+        }
+    }
+
+    return image;
+}
+
+qint64 file_size(const QString& filename) {
+    return QFileInfo { filename }.size();
+}
+
+} /* anonymous namespace */
+
+int main() {
+    const auto image { create_map() };
+    const QString snapshot_file { QDir::temp().filePath("ctbot_snapshot_bench.ctms") };
+    const QString png_file { QDir::temp().filePath("ctbot_snapshot_bench.png") };
+    const MapOverlays::Snapshot overlays;
+    const size_t pixels { static_cast<size_t>(MAP_PIXEL_SIZE) * MAP_PIXEL_SIZE };
+
+    bool success { true };
+    auto ns { bench::measure_ns([&]() { success &= MapSnapshot::save(snapshot_file, image, QPoint {}, 0, overlays); }) };
+    bench::report("MapSnapshot::save()", ns, pixels, "pixel");
+    std::printf("%-40s %10.2f ms, %lld bytes\n", "", ns / 1e6, file_size(snapshot_file));
+
+    QImage loaded { image.copy() };
+    loaded.fill(MapSnapshot::UNKNOWN_);
+    const size_t tiles_per_dim { MAP_PIXEL_SIZE / MapSnapshot::TILE_SIZE_ };
+    ns = bench::measure_ns([&]() {
+        MapSnapshot::Contents contents;
+        success &= MapSnapshot::load(
+            snapshot_file, tiles_per_dim,
+            [&loaded, tiles_per_dim](std::vector<MapSnapshot::Tile>&& tiles) {
+                for (const auto& tile : tiles) {
+                    const size_t x { (tile.index % tiles_per_dim) * MapSnapshot::TILE_SIZE_ };
+                    const size_t y { (tile.index / tiles_per_dim) * MapSnapshot::TILE_SIZE_ };
+                    for (size_t row {}; row < MapSnapshot::TILE_SIZE_; ++row) {
+                        std::copy_n(tile.data.data() + row * MapSnapshot::TILE_SIZE_, MapSnapshot::TILE_SIZE_,
+                            loaded.scanLine(static_cast<int>(y + row)) + x);
+                    }
+                }
+            },
+            contents);
+    });
+    bench::report("MapSnapshot::load()", ns, pixels, "pixel");
+    std::printf("%-40s %10.2f ms\n", "", ns / 1e6);
+
+    ns = bench::measure_ns([&]() { success &= image.save(png_file, "PNG"); }, 3);
+    bench::report("QImage::save(), PNG", ns, pixels, "pixel");
+    std::printf("%-40s %10.2f ms, %lld bytes\n", "", ns / 1e6, file_size(png_file));
+
+    QImage png;
+    ns = bench::measure_ns([&]() { success &= png.load(png_file, "PNG"); }, 3);
+    bench::report("QImage::load(), PNG", ns, pixels, "pixel");
+    std::printf("%-40s %10.2f ms\n", "", ns / 1e6);
+
+    QFile::remove(snapshot_file);
+    QFile::remove(png_file);
+
+    if (!success || loaded != image) {
+        std::printf("snapshot round trip failed\n");
+        return 1;
+    }
+
+    return 0;
+}
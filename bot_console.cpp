@@ -85,8 +85,8 @@ void BotConsole::register_buttons() {
         }
 
         cmd += "\r\n";
-        if (conn_manager_.get_socket()->isOpen()) {
-            conn_manager_.get_socket()->write(cmd.toUtf8(), cmd.length());
+        if (conn_manager_.is_open()) {
+            conn_manager_.write(cmd.toUtf8());
         }
 
         if constexpr (DEBUG_) {
@@ -96,9 +96,9 @@ void BotConsole::register_buttons() {
     QObject::connect(p_engine_->rootObjects().at(0)->findChild<QObject*>("Cmd"), SIGNAL(sendClicked(QString)), p_cmd_button_, SLOT(cppSlot(QString)));
 
     p_active_switch_ = new ConnectButton { [this](QString state, QString) {
-        if (conn_manager_.get_socket()->isOpen()) {
+        if (conn_manager_.is_open()) {
             const QString cmd { "c viewer " + state + "\r\n" };
-            conn_manager_.get_socket()->write(cmd.toUtf8(), cmd.length());
+            conn_manager_.write(cmd.toUtf8());
         }
     } };
     QObject::connect(
@@ -22,6 +22,8 @@
  * @date    06.01.2020
  */
 
+#include <cstring>
+
 #include "command.h"
 
 
@@ -34,38 +36,102 @@ CommandBase::CommandBase(const CommandCodes& cmd_code, const CommandCodes& subcm
     data_.to = to;
 }
 
+CommandBase::CommandBase(const CommandView& cmd) : has_crc_ {}, crc_ok_ {} {
+    assign(cmd);
+}
+
 CommandBase::CommandBase(QByteArray& buf) : has_crc_ {}, crc_ok_ {} {
-    while (buf.indexOf(static_cast<char>(CommandCodes::CMD_STARTCODE)) != 0) {
-        if (buf.indexOf(static_cast<char>(CommandCodes::CMD_STARTCODE)) == -1) {
-            throw std::runtime_error("CommandBase::CommandBase(): no cmd found");
-        }
-        buf.remove(0, 1);
+    std::string_view view { buf.constData(), static_cast<size_t>(buf.size()) };
+    try {
+        assign(parse(view));
+    } catch (const std::runtime_error&) {
+        buf.remove(0, buf.size() - static_cast<int>(view.size()));
+        throw;
+    }
+    buf.remove(0, buf.size() - static_cast<int>(view.size()));
+}
+
+CommandBase::CommandBase(std::string_view& buf) : has_crc_ {}, crc_ok_ {} {
+    assign(parse(buf));
+}
+
+ParseStatus CommandBase::try_parse(const std::string_view& buf, CommandView& cmd, size_t& consumed) {
+    consumed = 0;
+
+    /* skip everything in front of the next start code in one step */
+    const auto start { buf.find(static_cast<char>(CommandCodes::CMD_STARTCODE)) };
+    if (start == std::string_view::npos) {
+        consumed = buf.size();
+        return buf.size() ? ParseStatus::RESYNC : ParseStatus::NEED_MORE_DATA;
+    }
+    if (start) {
+        consumed = start;
+        return ParseStatus::RESYNC;
+    }
+
+    if (buf.size() < sizeof(CommandData)) {
+        return ParseStatus::NEED_MORE_DATA;
     }
 
-    if (buf.size() < static_cast<int>(sizeof(CommandData))) {
-        throw std::runtime_error("CommandBase::CommandBase(): no cmd found");
+    std::memcpy(&cmd.header, buf.data(), sizeof(CommandData));
+
+    if (cmd.header.CRC != codes_to_int(CommandCodes::CMD_STOPCODE)) {
+        /* start code was part of the data, search for the next one */
+        consumed = 1;
+        return ParseStatus::RESYNC;
+    }
+
+    const auto len { sizeof(CommandData) + cmd.header.payload };
+    if (buf.size() < len) {
+        return ParseStatus::NEED_MORE_DATA;
     }
 
-    std::copy(buf.begin(), buf.begin() + sizeof(CommandData), reinterpret_cast<char*>(&data_));
+    cmd.payload = buf.substr(sizeof(CommandData), cmd.header.payload);
+    consumed = len;
 
-    buf.remove(0, sizeof(CommandData));
+    return ParseStatus::OK;
+}
 
-    if (!valid()) {
-        std::cerr << "CommandBase::CommandBase(): invalid command:\n" << *this << "\n";
-        throw std::runtime_error("CommandBase::CommandBase(): invalid command (CRC)");
+CommandView CommandBase::parse(std::string_view& buf) {
+    while (true) {
+        CommandView cmd;
+        size_t consumed {};
+        const auto status { try_parse(buf, cmd, consumed) };
+        buf.remove_prefix(consumed);
+
+        switch (status) {
+            case ParseStatus::OK: return cmd;
+            case ParseStatus::RESYNC: break;
+            case ParseStatus::NEED_MORE_DATA: throw std::runtime_error("CommandBase::CommandBase(): no cmd found");
+            case ParseStatus::CRC_ERROR: throw std::runtime_error("CommandBase::CommandBase(): invalid command (CRC)");
+        }
     }
 }
 
+void CommandBase::assign(const CommandView& cmd) {
+    data_ = cmd.header;
+    payload_.assign(cmd.payload.begin(), cmd.payload.end());
+}
+
 bool CommandBase::append_payload(QByteArray& buf, const size_t len) {
+    std::string_view view { buf.constData(), static_cast<size_t>(buf.size()) };
+    if (!append_payload(view, len)) {
+        return false;
+    }
+    buf.remove(0, buf.size() - static_cast<int>(view.size()));
+
+    return true;
+}
+
+bool CommandBase::append_payload(std::string_view& buf, const size_t len) {
     const auto n { len > MAX_PAYLOAD ? MAX_PAYLOAD : len };
 
-    if (static_cast<int>(n) > buf.size()) {
+    if (n > buf.size()) {
         return false;
     }
 
-    payload_.reserve(n);
     payload_.assign(buf.begin(), buf.begin() + static_cast<ptrdiff_t>(n));
-    buf.remove(0, static_cast<int>(n));
+    buf.remove_prefix(n);
 
     return true;
 }
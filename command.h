@@ -26,11 +26,15 @@
 
 #include <cstdint>
 #include <iostream>
+#include <stdexcept>
+#include <string_view>
 #include <vector>
 #include <type_traits>
 
 #include <QByteArray>
 
+#include "crc16.h"
+
 
 namespace ctbot {
 
@@ -109,6 +113,10 @@ enum class CommandCodes : uint8_t {
     CMD_SUB_MAP_CIRCLE = 'C', /**< Kreis zeichnen */
     CMD_SUB_MAP_CLEAR_LINES = 'X', /**< Linien loeschen */
     CMD_SUB_MAP_CLEAR_CIRCLES = 'Y', /**< Kreise loeschen */
+    CMD_SUB_MAP_DELTA_REQUEST = 'r', /**< Aufforderung alle seit einer Generation (data_l: Bits 0-15, data_r: Bits 16-31) geaenderten Bloecke zu uebertragen */
+    CMD_SUB_MAP_DATA_RLE = 'Z', /**< Kompletter Map-Block (data_l), lauflaengenkodiert */
+    CMD_SUB_MAP_DATA_SKIP = 'K', /**< data_r unveraenderte Bloecke ab Block data_l, Payload: Hash je Block */
+    CMD_SUB_MAP_DELTA_DONE = 'S', /**< Ende einer Delta-Uebertragung, neue Generation wie bei CMD_SUB_MAP_DELTA_REQUEST, Payload: Bot-Position */
 
     /* Program transfer */
     CMD_PROGRAM = 'p', /**< Program data (Basic or ABL) */
@@ -143,6 +151,23 @@ struct CommandData {
 static_assert(sizeof(CommandData) == 12, "struct CommandData has wrong size, not packed?");
 
 
+enum class ParseStatus : uint8_t {
+    OK, /**< complete command found */
+    NEED_MORE_DATA, /**< buffer ends within a command, retry after more data was received */
+    RESYNC, /**< invalid data skipped, retry with the rest of the buffer */
+    CRC_ERROR, /**< complete command found, but its CRC is invalid */
+};
+
+
+/**
+ * @brief Command parsed by try_parse(), payload refers to the parsed buffer
+ */
+struct CommandView {
+    CommandData header;
+    std::string_view payload;
+};
+
+
 class CommandBase {
 protected:
     CommandData data_;
@@ -160,10 +185,25 @@ protected:
 
     void add_payload(const void* payload, const size_t len);
 
+    void assign(const CommandView& cmd);
+
+    static CommandView parse(std::string_view& buf);
+
 public:
+    /**
+     * @brief Parse a command from a buffer without throwing
+     * @param[in] buf: Buffer to parse
+     * @param[out] cmd: Parsed command, only valid for ParseStatus::OK
+     * @param[out] consumed: Number of bytes to remove from the front of buf before the next call
+     * @return Parse result
+     */
+    static ParseStatus try_parse(const std::string_view& buf, CommandView& cmd, size_t& consumed);
+
     CommandBase(const CommandData& cmd_data);
+    CommandBase(const CommandView& cmd);
     CommandBase(const CommandCodes& cmd_code, const CommandCodes& subcmd_code, int16_t data_l, int16_t data_r, uint8_t from, uint8_t to = ADDR_NOT_SET);
     CommandBase(QByteArray& buf);
+    CommandBase(std::string_view& buf);
     ~CommandBase() {}
 
     const auto& get_cmd() const {
@@ -252,6 +292,8 @@ public:
 
     bool append_payload(QByteArray& buf, const size_t len);
 
+    bool append_payload(std::string_view& buf, const size_t len);
+
     friend std::ostream& operator<<(std::ostream& os, const ctbot::CommandBase& v);
 
     static const uint8_t MAX_PAYLOAD { 255 }; /**< max. amount of payload in byte */
@@ -262,7 +304,9 @@ public:
 
 
 struct CRCNoCheck {
-    static bool checkCRC(CommandBase&) {
+    static constexpr bool HAS_CRC { false };
+
+    static bool checkCRC(const CommandView&) {
         return true;
     }
 
@@ -270,14 +314,70 @@ struct CRCNoCheck {
 };
 
 
+/**
+ * @brief CRC-16/MCRF4XX over header and payload, stored in the from (high byte) and to (low byte) fields of the header
+ * @note The from and to fields are zero while the CRC is calculated.
+ */
+struct CRC16 {
+    static constexpr bool HAS_CRC { true };
+
+    static uint16_t calcCRC(const CommandData& header, const void* payload, const size_t len) {
+        CommandData data { header };
+        data.from = 0;
+        data.to = 0;
+        return crc16_update(payload, len, crc16_update(&data, sizeof(data)));
+    }
+
+    static bool checkCRC(const CommandView& cmd) {
+        const uint16_t crc { static_cast<uint16_t>(cmd.header.to | (cmd.header.from << 8)) };
+        return calcCRC(cmd.header, cmd.payload.data(), cmd.payload.size()) == crc;
+    }
+
+    static void addCRC(CommandBase& cmd) {
+        cmd.append_crc(calcCRC(cmd.get_cmd(), cmd.get_payload().data(), cmd.get_payload_size()));
+    }
+};
+
+
+/**
+ * @brief Command with CRC handling of CRCPolicy
+ *
+ * The CRC covers header and payload. It is calculated by the constructors and again by add_payload(), so a command assembled from a constructor and
+ * add_payload() can be sent as it is. Changes of the header by the set_cmd_...() functions of CommandBase have to be followed by update_crc().
+ */
 template <class CRCPolicy = CRCNoCheck>
 class Command : public CommandBase, public CRCPolicy {
 protected:
-    void update_crc() {
-        CRCPolicy::addCRC(*this);
+    static CommandView parse(std::string_view& buf) {
+        while (true) {
+            CommandView cmd;
+            size_t consumed {};
+            const auto status { try_parse(buf, cmd, consumed) };
+            buf.remove_prefix(consumed);
+
+            switch (status) {
+                case ParseStatus::OK: return cmd;
+                case ParseStatus::RESYNC: break;
+                case ParseStatus::NEED_MORE_DATA: throw std::runtime_error("Command<>::Command(): no cmd found");
+                case ParseStatus::CRC_ERROR: throw std::runtime_error("Command<>::Command(): invalid command (CRC)");
+            }
+        }
     }
 
 public:
+    /**
+     * @brief Parse a command from a buffer without throwing, including the CRC check of CRCPolicy
+     * @see CommandBase::try_parse()
+     */
+    static ParseStatus try_parse(const std::string_view& buf, CommandView& cmd, size_t& consumed) {
+        const auto status { CommandBase::try_parse(buf, cmd, consumed) };
+        if (status == ParseStatus::OK && !CRCPolicy::checkCRC(cmd)) {
+            return ParseStatus::CRC_ERROR;
+        }
+
+        return status;
+    }
+
     Command(const CommandData& cmd_data) : CommandBase { cmd_data } {
         update_crc();
     }
@@ -288,17 +388,45 @@ public:
         update_crc();
     }
 
-    Command(QByteArray& buf) : CommandBase { buf } {
-        crc_ok_ = CRCPolicy::checkCRC(*this);
+    Command(const CommandView& cmd) : CommandBase { cmd } {
+        has_crc_ = CRCPolicy::HAS_CRC;
+        crc_ok_ = true;
+    }
 
-        if (!validCRC()) {
-            std::cerr << "Command<>::Command(): invalid command (CRC):\n" << *this << "\n";
-            throw std::runtime_error("Command<>::Command(): invalid command (CRC)");
+    /**
+     * @brief Parse a command from the front of a buffer, skips invalid data
+     * @param[in,out] buf: Buffer to parse, parsed data is removed
+     * @throw std::runtime_error if no complete command was found or its CRC is invalid
+     */
+    Command(std::string_view& buf) : Command { parse(buf) } {}
+
+    Command(QByteArray& buf) : CommandBase { CommandData {} } {
+        std::string_view view { buf.constData(), static_cast<size_t>(buf.size()) };
+        try {
+            assign(parse(view));
+            has_crc_ = CRCPolicy::HAS_CRC;
+            crc_ok_ = true;
+        } catch (const std::runtime_error&) {
+            buf.remove(0, buf.size() - static_cast<int>(view.size()));
+            throw;
         }
+        buf.remove(0, buf.size() - static_cast<int>(view.size()));
     }
 
     ~Command() = default;
 
+    /**
+     * @brief Recalculate the CRC over the current header and payload
+     */
+    void update_crc() {
+        CRCPolicy::addCRC(*this);
+    }
+
+    /**
+     * @brief Set the payload and recalculate the CRC
+     * @param[in] payload: Pointer to payload data
+     * @param[in] len: Size of payload in byte, limited to MAX_PAYLOAD
+     */
     void add_payload(const void* payload, const size_t len) {
         CommandBase::add_payload(payload, len);
         update_crc();
@@ -307,6 +435,7 @@ public:
 
 
 using CommandNoCRC = Command<CRCNoCheck>;
+using CommandCRC = Command<CRC16>;
 
 
 inline CommandData::CommandData()
@@ -0,0 +1,75 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    command_dispatcher.h
+ * @brief   Flat dispatch table for ct-Bot commands
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "command.h"
+
+
+namespace ctbot {
+
+/**
+ * @brief Handlers of commands, indexed by command code
+ *
+ * Command codes are a single byte, so the handlers of a command are found by indexing a table of 256 entries. Unregistered codes are reported by
+ * the return value instead of an exception.
+ */
+class CommandDispatcher {
+public:
+    using Handler = std::function<bool(const CommandBase&)>;
+
+    void add(const CommandCodes& cmd, Handler&& func) {
+        handlers_[static_cast<uint8_t>(cmd)].emplace_back(std::move(func));
+    }
+
+    /**
+     * @brief Call all handlers registered for the code of a command
+     * @param[in] cmd: Command to pass to the handlers
+     * @param[out] result: true, if all handlers returned true
+     * @return false, if no handler is registered for the command code
+     */
+    bool dispatch(const CommandBase& cmd, bool& result) const {
+        const auto& functions { handlers_[cmd.get_cmd_code_uint()] };
+        if (functions.empty()) {
+            return false;
+        }
+
+        result = true;
+        for (auto& func : functions) {
+            result &= func(cmd);
+        }
+        return true;
+    }
+
+private:
+    std::array<std::vector<Handler>, 256> handlers_;
+};
+
+} /* namespace ctbot */
@@ -24,57 +24,233 @@
 
 #include <QQmlApplicationEngine>
 #include <QObject>
-#include <QCoreApplication>
 #include <QQmlProperty>
-#include <QThread>
 #include <QTimer>
 #include <QDebug>
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <mutex>
 
 #include "connection_manager.h"
 
 
-ConnectionManagerBase::ConnectionManagerBase(QQmlApplicationEngine* p_engine)
-    : p_connect_button_ {}, p_engine_ { p_engine }, connected_ {}, p_shutdown_button_ {} {
-    QObject::connect(&socket_, &QTcpSocket::connected, p_engine_, [this]() {
+ConnectionManagerBase::ConnectionManagerBase(QQmlApplicationEngine* p_engine, const size_t buffer_size)
+    : p_connect_button_ {}, p_engine_ { p_engine }, in_buffer_ { buffer_size }, receive_time_ {}, connected_ {}, drain_scheduled_ {}, stalled_ {},
+      out_frames_ {}, out_bytes_ {}, out_writes_ {}, out_stats_ {}, p_shutdown_button_ {} {
+    /* socket signals are delivered in io_thread_, everything touching QML is passed on to the GUI thread */
+    QObject::connect(&socket_, &QTcpSocket::connected, &socket_, [this]() {
         socket_.setSocketOption(QAbstractSocket::LowDelayOption, 1);
-        qDebug() << "ConnectionManagerBase: Connected to " << socket_.peerName() << ":" << socket_.peerPort();
-        auto p_hostname { p_engine_->rootObjects().at(0)->findChild<QObject*>("Hostname") };
-        if (p_hostname) {
-            QMetaObject::invokeMethod(p_hostname, "connected", Q_ARG(QVariant, socket_.peerName()));
-        }
+        reset_receiver();
         connected_ = true;
 
-        connected_hook();
+        QMetaObject::invokeMethod(
+            p_engine_,
+            [this, peer = socket_.peerName(), port = socket_.peerPort()]() {
+                qDebug() << "ConnectionManagerBase: Connected to " << peer << ":" << port;
+                auto p_hostname { p_engine_->rootObjects().at(0)->findChild<QObject*>("Hostname") };
+                if (p_hostname) {
+                    QMetaObject::invokeMethod(p_hostname, "connected", Q_ARG(QVariant, peer));
+                }
+
+                latency_.reset();
+                connected_hook();
+            },
+            Qt::QueuedConnection);
     });
 
-    QObject::connect(&socket_, &QTcpSocket::disconnected, p_engine_, [this]() {
-        qDebug() << "ConnectionManagerBase: Connection closed.";
-        auto p_hostname { p_engine_->rootObjects().at(0)->findChild<QObject*>("Hostname") };
-        if (p_hostname) {
-            QMetaObject::invokeMethod(p_hostname, "disconnected", Q_ARG(QVariant, ""));
-        }
+    QObject::connect(&socket_, &QTcpSocket::disconnected, &socket_, [this]() {
+        connected_ = false;
 
+        QMetaObject::invokeMethod(
+            p_engine_,
+            [this]() {
+                qDebug() << "ConnectionManagerBase: Connection closed.";
+                qDebug() << "ConnectionManagerBase: latency p50 <" << latency_.get_percentile_us(.5) << "us, p99 <" << latency_.get_percentile_us(.99)
+                         << "us, max" << latency_.get_max_ns() / 1'000 << "us";
+                auto p_hostname { p_engine_->rootObjects().at(0)->findChild<QObject*>("Hostname") };
+                if (p_hostname) {
+                    QMetaObject::invokeMethod(p_hostname, "disconnected", Q_ARG(QVariant, ""));
+                }
+            },
+            Qt::QueuedConnection);
+    });
+
+    QObject::connect(&socket_, &QAbstractSocket::errorOccurred, &socket_, [this](QAbstractSocket::SocketError socketError) {
         connected_ = false;
+
+        QMetaObject::invokeMethod(
+            p_engine_,
+            [this, peer = socket_.peerName(), socketError]() {
+                qDebug() << "ConnectionManagerBase: Connection to " << peer << " failed:" << socketError;
+                auto p_hostname { p_engine_->rootObjects().at(0)->findChild<QObject*>("Hostname") };
+                if (p_hostname) {
+                    QMetaObject::invokeMethod(p_hostname, "disconnected", Q_ARG(QVariant, peer));
+                }
+            },
+            Qt::QueuedConnection);
     });
 
-    QObject::connect(&socket_, &QAbstractSocket::errorOccurred, p_engine_, [this](QAbstractSocket::SocketError socketError) {
-        qDebug() << "ConnectionManagerBase: Connection to " << socket_.peerName() << " failed:" << socketError;
-        auto p_hostname { p_engine_->rootObjects().at(0)->findChild<QObject*>("Hostname") };
-        if (p_hostname) {
-            QMetaObject::invokeMethod(p_hostname, "disconnected", Q_ARG(QVariant, socket_.peerName()));
+    QObject::connect(&socket_, &QTcpSocket::readyRead, &socket_, [this]() { receive(); });
+
+    drain_timer_.setSingleShot(true);
+    QObject::connect(&drain_timer_, &QTimer::timeout, p_engine_, [this]() {
+        drain_scheduled_ = false;
+        drain_clock_.start();
+        drain();
+
+        if (stalled_.exchange(false)) {
+            /* queue has space again, decode the rest of in_buffer_ and continue reading */
+            run_in_io_thread([this]() {
+                if (process_incoming()) {
+                    receive();
+                }
+            });
         }
+    });
 
-        connected_ = false;
+    out_stats_timer_.setInterval(1'000);
+    QObject::connect(&out_stats_timer_, &QTimer::timeout, p_engine_, [this]() {
+        const OutputStatistics last { out_stats_ };
+        out_stats_.frames = out_frames_;
+        out_stats_.bytes = out_bytes_;
+        out_stats_.writes = out_writes_;
+        out_stats_.frames_per_s = static_cast<double>(out_stats_.frames - last.frames);
+        out_stats_.bytes_per_s = static_cast<double>(out_stats_.bytes - last.bytes);
+        out_stats_.writes_per_s = static_cast<double>(out_stats_.writes - last.writes);
     });
+    out_stats_timer_.start();
+
+    socket_.moveToThread(&io_thread_);
+    io_thread_.setObjectName("ConnectionIO");
+    io_thread_.start();
 }
 
 ConnectionManagerBase::~ConnectionManagerBase() {
+    stop_io_thread();
+
     delete p_shutdown_button_;
     delete p_connect_button_;
 }
 
+void ConnectionManagerBase::stop_io_thread() {
+    if (!io_thread_.isRunning()) {
+        return;
+    }
+
+    /* the socket has to be destroyed by the thread owning it, no notifications to the GUI anymore */
+    auto p_main { QThread::currentThread() };
+    QMetaObject::invokeMethod(
+        &socket_,
+        [this, p_main]() {
+            QObject::disconnect(&socket_, nullptr, nullptr, nullptr);
+            socket_.abort();
+            socket_.moveToThread(p_main);
+        },
+        Qt::BlockingQueuedConnection);
+
+    io_thread_.quit();
+    io_thread_.wait();
+}
+
+int64_t ConnectionManagerBase::now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool ConnectionManagerBase::read_socket() {
+    bool new_data {};
+    while (!stalled_ && socket_.bytesAvailable() > 0 && in_buffer_.free_space()) {
+        auto p_dest { in_buffer_.prepare() };
+        const auto n { socket_.read(p_dest, static_cast<qint64>(in_buffer_.writable())) };
+        if (n <= 0) {
+            break;
+        }
+        in_buffer_.commit(static_cast<size_t>(n));
+        receive_time_ = now_ns();
+        new_data = true;
+
+        if (!process_incoming()) {
+            /* the rest stays in the socket until the GUI drained the queue */
+            break;
+        }
+    }
+
+    return new_data;
+}
+
+void ConnectionManagerBase::schedule_drain() {
+    if (drain_scheduled_.exchange(true)) {
+        return;
+    }
+
+    QMetaObject::invokeMethod(
+        p_engine_,
+        [this]() {
+            /* drain at most once per frame */
+            const auto elapsed { drain_clock_.isValid() ? drain_clock_.elapsed() : DRAIN_INTERVAL_MS_ };
+            drain_timer_.start(static_cast<int>(std::max<qint64>(0, DRAIN_INTERVAL_MS_ - elapsed)));
+        },
+        Qt::QueuedConnection);
+}
+
+void ConnectionManagerBase::close() {
+    connected_ = false;
+
+    run_in_io_thread([this]() {
+        /* frames written before are still in out_buffer_ */
+        flush_output();
+
+        if (socket_.isOpen()) {
+            socket_.close();
+        }
+    });
+}
+
+qint64 ConnectionManagerBase::write(const char* header, const size_t header_size, const char* payload, const size_t payload_size) {
+    if (!connected_) {
+        return -1;
+    }
+
+    bool first;
+    {
+        std::lock_guard<std::mutex> lock { out_mutex_ };
+        first = out_buffer_.isEmpty();
+        out_buffer_.append(header, static_cast<qsizetype>(header_size));
+        if (payload_size) {
+            out_buffer_.append(payload, static_cast<qsizetype>(payload_size));
+        }
+    }
+    ++out_frames_;
+
+    if (first) {
+        /* hand over to io_thread_ after the current event of the GUI thread, so all its frames are sent together */
+        QMetaObject::invokeMethod(p_engine_, [this]() { run_in_io_thread([this]() { flush_output(); }); }, Qt::QueuedConnection);
+    }
+
+    return static_cast<qint64>(header_size + payload_size);
+}
+
+void ConnectionManagerBase::flush_output() {
+    {
+        std::lock_guard<std::mutex> lock { out_mutex_ };
+        out_pending_.swap(out_buffer_);
+    }
+    if (out_pending_.isEmpty()) {
+        return;
+    }
+
+    if (socket_.isOpen()) {
+        socket_.write(out_pending_);
+        socket_.flush();
+        out_bytes_ += static_cast<uint64_t>(out_pending_.size());
+        ++out_writes_;
+    }
+
+    /* keeps the capacity for the next frames */
+    out_pending_.resize(0);
+}
+
 int ConnectionManagerBase::version_active() const {
     const auto version { QQmlProperty::read(p_engine_->rootObjects().at(0)->findChild<QObject*>("Hostname"), "version").toInt() };
     // qDebug() << "ConnectionManagerBase::version_active(): version set in GUI is " << version;
@@ -89,17 +265,16 @@ void ConnectionManagerBase::register_buttons() {
 
         auto object { p_engine_->rootObjects().at(0)->findChild<QObject*>("Hostname") };
         if (!connected_) {
-            socket_.connectToHost(hostname, static_cast<quint16>(port.toUInt()));
+            run_in_io_thread([this, hostname, port = static_cast<quint16>(port.toUInt())]() { socket_.connectToHost(hostname, port); });
         } else {
             disconnected_hook();
 
-            QTimer::singleShot(100, &socket_, [this, object, hostname]() {
-                if (!socket_.isOpen()) {
+            QTimer::singleShot(100, p_engine_, [this, object, hostname]() {
+                if (!connected_) {
                     return;
                 }
 
-                socket_.flush();
-                socket_.close();
+                close();
 
                 QMetaObject::invokeMethod(object, "disconnected", Q_ARG(QVariant, hostname));
             });
@@ -111,16 +286,8 @@ void ConnectionManagerBase::register_buttons() {
 }
 
 
-ConnectionManagerV1::ConnectionManagerV1(QQmlApplicationEngine* p_engine) : ConnectionManagerBase { p_engine } {
-    QObject::connect(&socket_, &QTcpSocket::readyRead, p_engine_, [this]() {
-        if (socket_.bytesAvailable()) {
-            // qDebug() << "socket_.bytesAvailable()=" << socket_.bytesAvailable();
-            in_buffer_.append(socket_.readAll());
-
-            process_incoming();
-        }
-    });
-
+ConnectionManagerV1::ConnectionManagerV1(QQmlApplicationEngine* p_engine)
+    : ConnectionManagerBase { p_engine, BUFFER_SIZE_ }, stats_ {}, require_crc_ {} {
     register_cmd(ctbot::CommandCodes::CMD_WELCOME, [](const ctbot::CommandBase&) {
         // std::cout << "CMD_WELCOME received: " << cmd << "\n";
         return true;
@@ -138,14 +305,16 @@ ConnectionManagerV1::ConnectionManagerV1(QQmlApplicationEngine* p_engine) : Conn
             QMetaObject::invokeMethod(p_hostname, "disconnected", Q_ARG(QVariant, ""));
         }
 
-        socket_.close();
-        connected_ = false;
+        close();
 
         return true;
     });
 }
 
-ConnectionManagerV1::~ConnectionManagerV1() {}
+ConnectionManagerV1::~ConnectionManagerV1() {
+    /* io_thread_ uses queue_ */
+    stop_io_thread();
+}
 
 int ConnectionManagerV1::get_version() const {
     return 1;
@@ -159,100 +328,137 @@ void ConnectionManagerV1::register_buttons() {
             return;
         }
 
-        if (!socket_.isOpen()) {
+        if (!is_open()) {
             return;
         }
 
         ctbot::CommandNoCRC cmd { ctbot::CommandCodes::CMD_SHUTDOWN, ctbot::CommandCodes::CMD_SUB_NORM, 0, 0, ctbot::CommandBase::ADDR_SIM,
             ctbot::CommandBase::ADDR_BROADCAST };
-        socket_.write(reinterpret_cast<const char*>(&cmd.get_cmd()), sizeof(ctbot::CommandData));
+        send(cmd);
 
         qDebug() << "Shutdown requested.";
 
-        socket_.flush();
-        socket_.close();
-        connected_ = false;
+        close();
     } };
 
     QObject::connect(p_engine_->rootObjects().at(0)->findChild<QObject*>("ShutdownButton"), SIGNAL(shutdownClicked()), p_shutdown_button_, SLOT(cppSlot()));
 }
 
 void ConnectionManagerV1::register_cmd(const ctbot::CommandCodes& cmd, std::function<bool(const ctbot::CommandBase&)>&& func) {
-    commands_[cmd].emplace_back(func);
+    commands_.add(cmd, std::move(func));
+}
+
+void ConnectionManagerV1::register_decoder(const ctbot::CommandCodes& cmd, Decoder&& func) {
+    decoders_[static_cast<uint8_t>(cmd)] = std::move(func);
 }
 
 bool ConnectionManagerV1::process_incoming() {
-    while (in_buffer_.size() > static_cast<int>(sizeof(ctbot::CommandData))) {
-        std::unique_ptr<ctbot::CommandNoCRC> p_cmd;
-        try {
-            p_cmd = std::make_unique<ctbot::CommandNoCRC>(in_buffer_);
-        } catch (const std::runtime_error& e) {
-            qDebug() << "ConnectionManagerV1: invalid command received: " << e.what();
+    return require_crc_ ? decode<ctbot::CRC16>() : decode<ctbot::CRCNoCheck>();
+}
+
+template <class CRCPolicy>
+bool ConnectionManagerV1::decode() {
+    bool pushed {};
+
+    /* a partially received frame stays in in_buffer_ until the next readyRead */
+    while (true) {
+        if (queue_.full()) {
+            stalled_ = true;
+            schedule_drain();
             return false;
         }
 
-        if (p_cmd->get_payload_size()) {
-            const int len { static_cast<int>(p_cmd->get_payload_size()) };
-            size_t n {};
-            while (in_buffer_.size() < len) {
-                QCoreApplication::processEvents();
-                if (socket_.bytesAvailable()) {
-                    in_buffer_.append(socket_.readAll());
-                }
-                if (in_buffer_.size() < len) {
-                    if (++n > 100) {
-                        break;
-                    }
-                    QThread::msleep(1);
+        ctbot::CommandView cmd;
+        size_t consumed {};
+        const auto status { ctbot::Command<CRCPolicy>::try_parse(in_buffer_.view(), cmd, consumed) };
+
+        switch (status) {
+            case ctbot::ParseStatus::NEED_MORE_DATA: {
+                if (pushed) {
+                    schedule_drain();
                 }
+                return true;
             }
-            if (in_buffer_.size() < len) {
-                continue;
+
+            case ctbot::ParseStatus::RESYNC: ++stats_.resyncs; break;
+
+            case ctbot::ParseStatus::CRC_ERROR: {
+                ++stats_.crc_errors;
+                if (DEBUG_) {
+                    qDebug() << "ConnectionManagerV1: invalid command (CRC) received.";
+                }
+                break;
             }
 
-            if (!p_cmd->append_payload(in_buffer_, p_cmd->get_payload_size())) {
-                qDebug() << "ConnectionManagerV1: could not receive payload of cmd:";
-                std::cout << *p_cmd << std::endl;
-                return false;
+            case ctbot::ParseStatus::OK: {
+                ++stats_.frames;
+                const auto& decoder { decoders_[cmd.header.command] };
+                if (decoder && decoder(cmd, receive_time_)) {
+                    break;
+                }
+
+                queue_.push(Event { cmd.header, std::string { cmd.payload }, CRCPolicy::HAS_CRC, receive_time_ });
+                pushed = true;
+                break;
             }
         }
 
-        evaluate_cmd(p_cmd.get());
+        in_buffer_.consume(consumed);
     }
+}
 
-    return true;
+void ConnectionManagerV1::drain() {
+    Event event;
+    while (queue_.pop(event)) {
+        const ctbot::CommandView view { event.header, event.payload };
+        if (event.has_crc) {
+            evaluate_cmd(ctbot::CommandCRC { view });
+        } else {
+            evaluate_cmd(ctbot::CommandNoCRC { view });
+        }
+
+        latency_.add(now_ns() - event.received);
+    }
 }
 
-bool ConnectionManagerV1::evaluate_cmd(const ctbot::CommandNoCRC* p_cmd) const {
-    try {
-        bool result { true };
-        for (auto& func : commands_.at(p_cmd->get_cmd_code())) {
-            result &= func(*p_cmd);
+bool ConnectionManagerV1::evaluate_cmd(const ctbot::CommandBase& cmd) {
+    bool result {};
+    if (!commands_.dispatch(cmd, result)) {
+        ++stats_.unregistered;
+        if (DEBUG_) {
+            qDebug() << "ConnectionManagerV1::evaluate_cmd(): CMD code '" << static_cast<char>(cmd.get_cmd_code_uint()) << "' not registered:";
+            std::cout << cmd << std::endl;
         }
-        return result;
-    } catch (const std::out_of_range&) {
-        qDebug() << "ConnectionManagerV1::evaluate_cmd(): CMD code '" << static_cast<char>(p_cmd->get_cmd_code_uint()) << "' not registered:";
-        std::cout << *p_cmd << std::endl;
         return false;
     }
+
+    return result;
 }
 
 
-ConnectionManagerV2::ConnectionManagerV2(QQmlApplicationEngine* p_engine) : ConnectionManagerBase { p_engine } {
-    QObject::connect(&socket_, &QTcpSocket::readyRead, p_engine_, [this]() {
-        bool new_data {};
-        while (socket_.canReadLine()) {
-            in_buffer_.append(socket_.readLine());
-            new_data = true;
-            QCoreApplication::processEvents();
-        }
-        if (new_data) {
-            process_incoming();
+ConnectionManagerV2::ConnectionManagerV2(QQmlApplicationEngine* p_engine) : ConnectionManagerBase { p_engine, BUFFER_SIZE_ } {}
+
+ConnectionManagerV2::~ConnectionManagerV2() {
+    /* io_thread_ uses queue_ */
+    stop_io_thread();
+}
+
+void ConnectionManagerV2::receive() {
+    while (read_socket() && !in_buffer_.free_space()) {
+        /* buffer filled up without a complete frame, pass it on as plain text */
+        if (!push("", in_buffer_.view())) {
+            return;
         }
-    });
+        schedule_drain();
+        in_buffer_.clear();
+        tokenizer_.reset();
+    }
 }
 
-ConnectionManagerV2::~ConnectionManagerV2() {}
+void ConnectionManagerV2::reset_receiver() {
+    in_buffer_.clear();
+    tokenizer_.reset();
+}
 
 void ConnectionManagerV2::register_buttons() {
     ConnectionManagerBase::register_buttons();
@@ -262,23 +468,15 @@ void ConnectionManagerV2::register_buttons() {
             return;
         }
 
-        if (!socket_.isOpen()) {
+        if (!is_open()) {
             return;
         }
 
-        socket_.write("halt\n", 5);
+        write("halt\n", 5);
 
         qDebug() << "Shutdown requested.";
 
-        QTimer::singleShot(100, &socket_, [this]() {
-            if (!socket_.isOpen()) {
-                return;
-            }
-
-            socket_.flush();
-            socket_.close();
-            connected_ = false;
-        });
+        QTimer::singleShot(100, p_engine_, [this]() { close(); });
     } };
 
     QObject::connect(p_engine_->rootObjects().at(0)->findChild<QObject*>("ShutdownButton"), SIGNAL(shutdownClicked()), p_shutdown_button_, SLOT(cppSlot()));
@@ -288,91 +486,81 @@ void ConnectionManagerV2::register_cmd(const std::string_view& cmd, std::functio
     commands_[std::string(cmd)].emplace_back(func);
 }
 
+void ConnectionManagerV2::register_decoder(const std::string_view& cmd, Decoder&& func) {
+    decoders_[std::string(cmd)] = std::move(func);
+}
+
 int ConnectionManagerV2::get_version() const {
     return 2;
 }
 
-bool ConnectionManagerV2::process_incoming() {
-    bool result { true };
+bool ConnectionManagerV2::push(const std::string_view& tag, const std::string_view& data) {
+    if (!queue_.push(Event { std::string { tag }, std::string { data }, receive_time_ })) {
+        stalled_ = true;
+        schedule_drain();
+        return false;
+    }
 
-    if (in_buffer_.size()) {
-        const auto start { in_buffer_.indexOf("<", 0) };
+    return true;
+}
+
+bool ConnectionManagerV2::process_incoming() {
+    bool pushed {};
 
+    FrameTokenizer::Token token;
+    size_t consumed {};
+    while (tokenizer_.next(in_buffer_.view(), token, consumed)) {
         if (DEBUG_) {
-            qDebug() << "ConnectionManagerV2::process_incoming(): start=" << start << "input= " << in_buffer_;
+            qDebug() << "ConnectionManagerV2::process_incoming(): tag=" << QString::fromUtf8(token.tag.data(), token.tag.size())
+                     << "data=" << QString::fromUtf8(token.data.data(), token.data.size());
         }
 
-        if (start == -1) {
-            if (DEBUG_) {
-                qDebug() << "ConnectionManagerV2::process_incoming(): no cmd found (1):" << in_buffer_;
-            }
-            evaluate_cmd("", std::string_view(in_buffer_.data(), in_buffer_.size()));
-            in_buffer_.clear();
-            return true;
-        }
-        if (start) {
-            auto prefix { in_buffer_.left(start) };
-            if (DEBUG_) {
-                qDebug() << "ConnectionManagerV2::process_incoming(): no cmd found (2):" << prefix;
-            }
-            evaluate_cmd("", std::string_view(prefix.data(), prefix.size()));
-            in_buffer_.remove(0, start);
+        const auto it { decoders_.find(token.tag) };
+        if (it != decoders_.end() && it->second(token.data, receive_time_)) {
+            in_buffer_.consume(consumed);
+            continue;
         }
 
-        try {
-            std::cmatch matches;
-            while (std::regex_search(in_buffer_.data(), matches, cmd_regex_)) {
-                if (matches.ready()) {
-                    if (DEBUG_) {
-                        // qDebug() << "ConnectionManagerV2::process_incoming(): Match found:";
-                        // for (size_t i { 1 }; i < matches.size(); ++i) {
-                        //     qDebug() << i << ":" << QString::fromStdString(matches[i].str());
-                        // }
-                    }
-
-                    // if (matches[1].str() == "log") {
-                    //     qDebug() << "ConnectionManagerV2::process_incoming(): input=" << in_buffer_;
-                    //     qDebug() << "ConnectionManagerV2::process_incoming(): match=" << QString::fromStdString(matches[2].str());
-                    // }
-
-                    result &= evaluate_cmd(matches[1].str(), matches[2].str());
-
-                    in_buffer_.remove(0, matches[0].length());
-
-                    if (DEBUG_) {
-                        qDebug() << "ConnectionManagerV2::process_incoming(): next input= " << in_buffer_;
-                    }
-
-                    if (in_buffer_.indexOf("<", 0)) {
-                        return result;
-                    }
-                }
-            }
-        } catch (std::regex_error& e) {
-            qDebug() << "ConnectionManagerV2::process_incoming(): regex error " << e.what();
+        /* token refers to the receive buffer, so it is consumed after copying to the queue */
+        if (!push(token.tag, token.data)) {
+            tokenizer_.reset();
+            return false;
         }
+        pushed = true;
+        in_buffer_.consume(consumed);
     }
 
-    return result;
+    if (pushed) {
+        schedule_drain();
+    }
+
+    return true;
+}
+
+void ConnectionManagerV2::drain() {
+    Event event;
+    while (queue_.pop(event)) {
+        evaluate_cmd(event.tag, event.data);
+        latency_.add(now_ns() - event.received);
+    }
 }
 
 bool ConnectionManagerV2::evaluate_cmd(const std::string_view& cmd, const std::string_view& data) const {
     // qDebug() << "ConnectionManagerV2::evaluate_cmd(): cmd=" << QString::fromUtf8(cmd.data(), cmd.size())
     //          << "data=" << QString::fromUtf8(data.data(), data.size());
 
-    try {
-        bool result { true };
-        for (auto& func : commands_.at(std::string(cmd))) {
-            result &= func(data);
-        }
-
-        return result;
-    } catch (const std::out_of_range&) {
+    const auto it { commands_.find(cmd) };
+    if (it == commands_.end()) {
         qDebug() << "ConnectionManagerV2::evaluate_cmd(): CMD code " << QString::fromUtf8(cmd.data(), cmd.size()) << " not registered.";
         return false;
     }
 
-    return false;
+    bool result { true };
+    for (auto& func : it->second) {
+        result &= func(data);
+    }
+
+    return result;
 }
 
 void ConnectionManagerV2::connected_hook() {
@@ -380,12 +568,12 @@ void ConnectionManagerV2::connected_hook() {
         return;
     }
 
-    QTimer::singleShot(100, &socket_, [this]() {
-        if (!socket_.isOpen()) {
+    QTimer::singleShot(100, p_engine_, [this]() {
+        if (!is_open()) {
             return;
         }
-     
-        socket_.write("c viewer 1\n", 11);
+
+        write("c viewer 1\n", 11);
         qDebug() << "ConnectionManagerV2::connected_hook(): viewer config enabled";
     });
 }
@@ -395,10 +583,10 @@ void ConnectionManagerV2::disconnected_hook() {
         return;
     }
 
-    if (!socket_.isOpen()) {
+    if (!is_open()) {
         return;
     }
-    
-    socket_.write("c viewer 0\n", 11);
+
+    write("c viewer 0\n", 11);
     qDebug() << "ConnectionManagerV2::disconnected_hook(): viewer config disabled";
 }
@@ -26,56 +26,220 @@
 
 #include <QTcpSocket>
 #include <QByteArray>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QTimer>
 
+#include <array>
+#include <atomic>
 #include <map>
+#include <mutex>
 #include <vector>
 #include <string>
 #include <functional>
-#include <regex>
+#include <string_view>
 
 #include "command.h"
+#include "command_dispatcher.h"
 #include "connect_button.h"
+#include "frame_tokenizer.h"
+#include "latency_histogram.h"
+#include "receive_buffer.h"
+#include "spsc_queue.h"
 
 
 class QQmlApplicationEngine;
 
+/**
+ * @brief Base class of connection managers
+ *
+ * The socket, the receive buffer and the protocol decoding live in a dedicated I/O thread. Decoded commands are passed to the GUI thread by a
+ * lock-free queue, which is drained at most once per frame; all registered handlers and hooks run in the GUI thread. If the queue is full,
+ * decoding pauses and the socket is not read until the GUI caught up, so TCP flow control slows down the sender.
+ */
 class ConnectionManagerBase {
     ConnectButton* p_connect_button_;
 
+public:
+    struct OutputStatistics {
+        uint64_t frames; /**< number of frames sent */
+        uint64_t bytes; /**< number of bytes sent */
+        uint64_t writes; /**< number of writes to the socket, i.e. system calls */
+        double frames_per_s;
+        double bytes_per_s;
+        double writes_per_s;
+    };
+
 protected:
     static constexpr bool DEBUG_ { false };
+    static constexpr int DRAIN_INTERVAL_MS_ { 16 };
+    static constexpr size_t QUEUE_SIZE_ { 4096 };
 
     QQmlApplicationEngine* p_engine_;
-    QTcpSocket socket_;
-    QByteArray in_buffer_;
-    bool connected_;
+    QThread io_thread_;
+    QTcpSocket socket_; /**< lives in io_thread_, only to be used from there */
+    ReceiveBuffer in_buffer_; /**< used by io_thread_ only */
+    int64_t receive_time_; /**< time of last read from socket in ns, used by io_thread_ only */
+    std::atomic<bool> connected_;
+    std::atomic<bool> drain_scheduled_;
+    std::atomic<bool> stalled_; /**< decoding paused because the queue is full */
+    QTimer drain_timer_;
+    QElapsedTimer drain_clock_;
+    LatencyHistogram latency_;
+    std::mutex out_mutex_;
+    QByteArray out_buffer_; /**< frames to send, protected by out_mutex_ */
+    QByteArray out_pending_; /**< frames being sent, used by io_thread_ only */
+    std::atomic<uint64_t> out_frames_;
+    std::atomic<uint64_t> out_bytes_;
+    std::atomic<uint64_t> out_writes_;
+    OutputStatistics out_stats_;
+    QTimer out_stats_timer_;
     ConnectButton* p_shutdown_button_;
 
+    /**
+     * @brief Decode in_buffer_ and push the commands to the queue, called by io_thread_
+     * @return false, if decoding paused because the queue is full
+     */
     virtual bool process_incoming() = 0;
+
+    /**
+     * @brief Pop all queued commands and call their handlers, called by GUI thread
+     */
+    virtual void drain() = 0;
+
+    /**
+     * @brief Reset decoder state for a new connection, called by io_thread_
+     */
+    virtual void reset_receiver() {
+        in_buffer_.clear();
+    }
+
+    /**
+     * @brief Read from socket and decode, called by io_thread_ on readyRead
+     */
+    virtual void receive() {
+        read_socket();
+    }
+
     virtual void register_buttons();
     virtual void connected_hook() {}
     virtual void disconnected_hook() {}
+    bool read_socket();
+    void schedule_drain();
+    void flush_output();
+    void close();
+
+    /**
+     * @brief Run a function in io_thread_
+     */
+    template <typename F>
+    void run_in_io_thread(F&& func) {
+        QMetaObject::invokeMethod(&socket_, std::forward<F>(func), Qt::QueuedConnection);
+    }
+
+    /**
+     * @return Monotonic time in ns, comparable between threads
+     */
+    static int64_t now_ns();
 
 public:
-    ConnectionManagerBase(QQmlApplicationEngine* p_engine);
+    ConnectionManagerBase(QQmlApplicationEngine* p_engine, const size_t buffer_size);
 
     virtual ~ConnectionManagerBase();
 
     virtual int get_version() const = 0;
     int version_active() const;
 
-    auto get_socket() {
-        return &socket_;
+    /**
+     * @brief Close the socket and stop io_thread_, no decoder is called afterwards; called by the GUI thread
+     * @note Has to be called before the objects referenced by decoders are destroyed
+     */
+    void stop_io_thread();
+
+    bool is_open() const {
+        return connected_;
+    }
+
+    /**
+     * @brief Send a frame to the bot, called by the GUI thread
+     *
+     * Header and payload are copied into one outgoing buffer. All frames written during one turn of the GUI event loop are sent by the I/O thread
+     * with a single write to the socket.
+     * @param[in] header: Header data
+     * @param[in] header_size: Size of header in byte
+     * @param[in] payload: Payload data, may be nullptr if payload_size is 0
+     * @param[in] payload_size: Size of payload in byte
+     * @return Number of bytes queued or -1, if not connected
+     */
+    qint64 write(const char* header, const size_t header_size, const char* payload, const size_t payload_size);
+
+    qint64 write(const char* data, const size_t size) {
+        return write(data, size, nullptr, 0);
+    }
+
+    qint64 write(const QByteArray& data) {
+        return write(data.constData(), static_cast<size_t>(data.size()));
+    }
+
+    /**
+     * @return Statistics of sent data, rates are updated once per second
+     */
+    const OutputStatistics& get_output_statistics() const {
+        return out_stats_;
+    }
+
+    /**
+     * @brief Add a latency to the histogram, for commands handled by a decoder; called by the GUI thread
+     * @param[in] received: Time of reception of the command in ns, as passed to the decoder
+     */
+    void add_latency(const int64_t received) {
+        latency_.add(now_ns() - received);
+    }
+
+    /**
+     * @return Latency from reading a command from the socket until all its handlers returned or, for commands handled by a decoder, until each
+     * of its values was passed to the model
+     */
+    const LatencyHistogram& get_latency_histogram() const {
+        return latency_;
     }
 };
 
 
 class ConnectionManagerV1 : public ConnectionManagerBase {
-    std::map<ctbot::CommandCodes /*cmd*/, std::vector<std::function<bool(const ctbot::CommandBase&)>> /*functions*/> commands_;
+    static constexpr size_t BUFFER_SIZE_ { 64 * 1024 };
+
+public:
+    using Decoder = std::function<bool(const ctbot::CommandView& /*cmd*/, const int64_t /*timestamp*/)>;
+
+    struct Statistics {
+        std::atomic<uint64_t> frames; /**< number of valid commands received */
+        std::atomic<uint64_t> resyncs; /**< number of times invalid data was skipped */
+        std::atomic<uint64_t> crc_errors; /**< number of commands dropped because of an invalid CRC */
+        std::atomic<uint64_t> unregistered; /**< number of commands without registered handler */
+    };
+
+private:
+    struct Event {
+        ctbot::CommandData header;
+        std::string payload;
+        bool has_crc;
+        int64_t received; /**< time of read from socket in ns */
+    };
+
+    ctbot::CommandDispatcher commands_;
+    std::array<Decoder, 256> decoders_; /**< decoders indexed by command code, called by io_thread_ */
+    SpscQueue<Event, QUEUE_SIZE_> queue_;
+    Statistics stats_;
+    std::atomic<bool> require_crc_;
+
+    template <class CRCPolicy>
+    bool decode();
 
 protected:
     virtual bool process_incoming() override;
-    bool evaluate_cmd(const ctbot::CommandNoCRC* p_cmd) const;
+    virtual void drain() override;
+    bool evaluate_cmd(const ctbot::CommandBase& cmd);
 
 public:
     ConnectionManagerV1(QQmlApplicationEngine* p_engine);
@@ -85,16 +249,67 @@ public:
     virtual int get_version() const override;
     virtual void register_buttons() override;
     void register_cmd(const ctbot::CommandCodes& cmd, std::function<bool(const ctbot::CommandBase&)>&& func);
+
+    /**
+     * @brief Register a decoder for telemetry, which is called by the I/O thread instead of passing the command to the GUI thread
+     * @param[in] cmd: Command code
+     * @param[in] func: Decoder, gets the command and its time of reception in ns; returns false to pass the command on to the handlers
+     * @note The decoder must not touch any GUI objects, it should push its values to a TelemetryRing. Register before connecting.
+     */
+    void register_decoder(const ctbot::CommandCodes& cmd, Decoder&& func);
+
+    /**
+     * @brief Send a command with its payload as one frame, called by the GUI thread
+     * @return Number of bytes queued or -1, if not connected
+     */
+    qint64 send(const ctbot::CommandBase& cmd) {
+        return write(reinterpret_cast<const char*>(&cmd.get_cmd()), sizeof(ctbot::CommandData), reinterpret_cast<const char*>(cmd.get_payload().data()),
+            cmd.get_payload_size());
+    }
+
+    const auto& get_statistics() const {
+        return stats_;
+    }
+
+    /**
+     * @brief Enable or disable the CRC check for incoming commands
+     * @param[in] require: If true, only commands with a valid CRC-16 are accepted
+     */
+    void set_require_crc(const bool require) {
+        require_crc_ = require;
+    }
+
+    bool get_require_crc() const {
+        return require_crc_;
+    }
 };
 
 
 class ConnectionManagerV2 : public ConnectionManagerBase {
-    std::map<std::string /*cmd*/, std::vector<std::function<bool(const std::string_view&)>> /*functions*/> commands_;
+    static constexpr size_t BUFFER_SIZE_ { 256 * 1024 };
 
-protected:
-    static inline const std::regex cmd_regex_ { R"(<(\w+)>((?:.|\r|\n)+?)<(/\1)>\r\n)" };
+public:
+    using Decoder = std::function<bool(const std::string_view& /*data*/, const int64_t /*timestamp*/)>;
+
+private:
+    struct Event {
+        std::string tag;
+        std::string data;
+        int64_t received; /**< time of read from socket in ns */
+    };
+
+    std::map<std::string /*cmd*/, std::vector<std::function<bool(const std::string_view&)>> /*functions*/, std::less<>> commands_;
+    std::map<std::string /*cmd*/, Decoder, std::less<>> decoders_; /**< called by io_thread_ */
+    FrameTokenizer tokenizer_; /**< used by io_thread_ only */
+    SpscQueue<Event, QUEUE_SIZE_> queue_;
 
+    bool push(const std::string_view& tag, const std::string_view& data);
+
+protected:
     virtual bool process_incoming() override;
+    virtual void drain() override;
+    virtual void reset_receiver() override;
+    virtual void receive() override;
     virtual void connected_hook() override;
     virtual void disconnected_hook() override;
     bool evaluate_cmd(const std::string_view& cmd, const std::string_view& data) const;
@@ -107,4 +322,10 @@ public:
     virtual int get_version() const override;
     virtual void register_buttons() override;
     void register_cmd(const std::string_view& cmd, std::function<bool(const std::string_view&)>&& func);
+
+    /**
+     * @brief Register a decoder for telemetry, which is called by the I/O thread instead of passing the frame to the GUI thread
+     * @see ConnectionManagerV1::register_decoder()
+     */
+    void register_decoder(const std::string_view& cmd, Decoder&& func);
 };
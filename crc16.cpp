@@ -0,0 +1,80 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    crc16.cpp
+ * @brief   CRC-16 calculation
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#include <array>
+
+#include "crc16.h"
+
+
+namespace ctbot {
+
+namespace {
+
+using crc_table_t = std::array<std::array<uint16_t, 256>, 8>;
+
+constexpr crc_table_t create_tables() {
+    crc_table_t tables {};
+
+    for (uint16_t i {}; i < 256; ++i) {
+        uint16_t crc { i };
+        for (size_t bit {}; bit < 8; ++bit) {
+            crc = (crc & 1) ? static_cast<uint16_t>((crc >> 1) ^ 0x8408) : static_cast<uint16_t>(crc >> 1);
+        }
+        tables[0][i] = crc;
+    }
+
+    /* tables[k][i]: CRC of byte i followed by k zero bytes */
+    for (size_t k { 1 }; k < tables.size(); ++k) {
+        for (size_t i {}; i < 256; ++i) {
+            const auto prev { tables[k - 1][i] };
+            tables[k][i] = static_cast<uint16_t>((prev >> 8) ^ tables[0][prev & 0xff]);
+        }
+    }
+
+    return tables;
+}
+
+constexpr crc_table_t crc_tables { create_tables() };
+
+} /* anonymous namespace */
+
+uint16_t crc16_update(const void* data, const size_t len, uint16_t crc) {
+    auto ptr { static_cast<const uint8_t*>(data) };
+    auto n { len };
+
+    while (n >= 8) {
+        crc = crc_tables[7][(ptr[0] ^ crc) & 0xff] ^ crc_tables[6][(ptr[1] ^ (crc >> 8)) & 0xff] ^ crc_tables[5][ptr[2]] ^ crc_tables[4][ptr[3]]
+            ^ crc_tables[3][ptr[4]] ^ crc_tables[2][ptr[5]] ^ crc_tables[1][ptr[6]] ^ crc_tables[0][ptr[7]];
+        ptr += 8;
+        n -= 8;
+    }
+
+    while (n--) {
+        crc = static_cast<uint16_t>((crc >> 8) ^ crc_tables[0][(crc ^ *ptr++) & 0xff]);
+    }
+
+    return crc;
+}
+
+} /* namespace ctbot */
@@ -0,0 +1,45 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    crc16.h
+ * @brief   CRC-16 calculation
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace ctbot {
+
+static constexpr uint16_t CRC16_INIT { 0xffff }; /**< initial value of CRC-16/MCRF4XX */
+
+/**
+ * @brief Update a CRC-16/MCRF4XX (CCITT polynom 0x1021, reflected, no final xor) with a block of data
+ * @param[in] data: Pointer to data
+ * @param[in] len: Length of data in byte
+ * @param[in] crc: CRC of previous data or CRC16_INIT
+ * @return Updated CRC
+ * @note Bitwise identical to a loop over _crc_ccitt_update() of avr-libc, but processes 8 bytes per step (slicing-by-8).
+ */
+uint16_t crc16_update(const void* data, const size_t len, uint16_t crc = CRC16_INIT);
+
+} /* namespace ctbot */
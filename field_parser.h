@@ -0,0 +1,238 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    field_parser.h
+ * @brief   Single-pass parser for "key: v1 v2" data lines
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+
+
+/**
+ * @brief Locale-independent parsing of a decimal number like "-12.345"
+ * @param[in] first: Begin of input
+ * @param[in] last: End of input
+ * @param[out] value: Reference to result
+ * @return Pointer to first character not parsed or nullptr in case of an error
+ * @note Thread-safe, uses std::from_chars() if the standard library supports it for floating point types
+ */
+inline const char* parse_float(const char* first, const char* last, float& value) {
+#if defined __cpp_lib_to_chars && __cpp_lib_to_chars >= 201611L
+    const auto [ptr, ec] { std::from_chars(first, last, value, std::chars_format::fixed) };
+    return ec == std::errc() ? ptr : nullptr;
+#else
+    auto ptr { first };
+    const bool negative { ptr != last && *ptr == '-' };
+    if (negative) {
+        ++ptr;
+    }
+
+    uint64_t mantissa {};
+    int exponent {};
+    bool digits {};
+    for (; ptr != last && *ptr >= '0' && *ptr <= '9'; ++ptr) {
+        if (mantissa < 100'000'000'000'000'000ULL) {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*ptr - '0');
+        } else {
+            ++exponent;
+        }
+        digits = true;
+    }
+    if (ptr != last && *ptr == '.') {
+        for (++ptr; ptr != last && *ptr >= '0' && *ptr <= '9'; ++ptr) {
+            if (mantissa < 100'000'000'000'000'000ULL) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*ptr - '0');
+                --exponent;
+            }
+            digits = true;
+        }
+    }
+    if (!digits) {
+        return nullptr;
+    }
+
+    double result { static_cast<double>(mantissa) };
+    for (; exponent > 0; --exponent) {
+        result *= 10.;
+    }
+    for (; exponent < 0; ++exponent) {
+        result /= 10.;
+    }
+    value = static_cast<float>(negative ? -result : result);
+
+    return ptr;
+#endif
+}
+
+
+enum class FieldType : uint8_t {
+    INT, /**< (signed) integer values */
+    FLOAT, /**< decimal values with '.' as separator */
+};
+
+
+struct FieldSpec {
+    std::string_view key; /**< key without trailing ':' */
+    uint8_t count; /**< number of values following the key */
+    FieldType type;
+
+    constexpr FieldSpec(const std::string_view& key, const uint8_t count, const FieldType type = FieldType::INT)
+        : key { key }, count { count }, type { type } {}
+};
+
+
+/**
+ * @brief Parses all fields of a line like "enc: -12 13 dist: 100 200 bat: 7.42 3.71" in one scan
+ * @tparam N: Number of fields
+ *
+ * The field table is checked at compile time, field indices for the result can be obtained as constant expressions with index().
+ */
+template <size_t N>
+class FieldParser {
+public:
+    static constexpr size_t MAX_VALUES_ { 3 };
+
+    struct Result {
+        std::array<std::array<float, MAX_VALUES_>, N> values;
+        std::bitset<N> found;
+
+        bool has(const size_t field) const {
+            return found.test(field);
+        }
+
+        template <typename T = float>
+        T get(const size_t field, const size_t n = 0) const {
+            return static_cast<T>(values[field][n]);
+        }
+    };
+
+private:
+    const std::array<FieldSpec, N> fields_;
+
+    static constexpr bool is_key_char(const char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    }
+
+    static const char* parse_value(const char* first, const char* last, const FieldType type, float& value) {
+        if (type == FieldType::INT) {
+            int32_t tmp;
+            const auto [ptr, ec] { std::from_chars(first, last, tmp) };
+            if (ec != std::errc()) {
+                return nullptr;
+            }
+            value = static_cast<float>(tmp);
+            return ptr;
+        }
+
+        return parse_float(first, last, value);
+    }
+
+    constexpr size_t find(const std::string_view& key) const {
+        for (size_t i {}; i < N; ++i) {
+            if (fields_[i].key == key) {
+                return i;
+            }
+        }
+        return N;
+    }
+
+public:
+    constexpr FieldParser(const std::array<FieldSpec, N>& fields) : fields_ { fields } {
+        for (size_t i {}; i < N; ++i) {
+            if (fields_[i].key.empty() || fields_[i].count == 0 || fields_[i].count > MAX_VALUES_) {
+                throw std::logic_error("FieldParser: invalid field"); // compile time error if used in a constant expression
+            }
+            for (auto c : fields_[i].key) {
+                if (!is_key_char(c)) {
+                    throw std::logic_error("FieldParser: invalid key");
+                }
+            }
+            if (find(fields_[i].key) != i) {
+                throw std::logic_error("FieldParser: duplicate key");
+            }
+        }
+    }
+
+    /**
+     * @brief Get index of a field in the result
+     * @param[in] key: Key of the field
+     * @return Index of field
+     */
+    constexpr size_t index(const std::string_view& key) const {
+        const auto i { find(key) };
+        if (i == N) {
+            throw std::logic_error("FieldParser: unknown key");
+        }
+        return i;
+    }
+
+    Result parse(const std::string_view& line) const {
+        Result result {};
+
+        const auto begin { line.data() };
+        const auto end { begin + line.size() };
+        auto ptr { begin };
+
+        while (ptr != end) {
+            /* find next key */
+            const auto p_colon { static_cast<const char*>(std::char_traits<char>::find(ptr, static_cast<size_t>(end - ptr), ':')) };
+            if (!p_colon) {
+                break;
+            }
+            auto p_key { p_colon };
+            while (p_key != ptr && is_key_char(*(p_key - 1))) {
+                --p_key;
+            }
+            ptr = p_colon + 1;
+
+            const auto i { find(std::string_view { p_key, static_cast<size_t>(p_colon - p_key) }) };
+            if (i == N) {
+                continue;
+            }
+
+            /* parse values of this field */
+            const auto& field { fields_[i] };
+            bool valid { true };
+            for (size_t n {}; n < field.count; ++n) {
+                while (ptr != end && *ptr == ' ') {
+                    ++ptr;
+                }
+                const auto p_next { parse_value(ptr, end, field.type, result.values[i][n]) };
+                if (!p_next) {
+                    valid = false;
+                    break;
+                }
+                ptr = p_next;
+            }
+            result.found.set(i, valid);
+        }
+
+        return result;
+    }
+};
@@ -0,0 +1,105 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    frame_tokenizer.cpp
+ * @brief   Streaming tokenizer for text based ct-Bot frames
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#include <algorithm>
+
+#include "frame_tokenizer.h"
+
+
+bool FrameTokenizer::next_text(const std::string_view& buf, const size_t from, std::string_view& text, size_t& consumed) {
+    /* plain text ends in front of the next '<', which may start a tag; text without a '<' is passed on at once, even without a newline */
+    auto end { buf.find('<', from) };
+    if (end == std::string_view::npos) {
+        end = buf.size();
+    }
+
+    text = buf.substr(0, end);
+    consumed = end;
+
+    return true;
+}
+
+bool FrameTokenizer::next(const std::string_view& buf, Token& token, size_t& consumed) {
+    token.tag = {};
+    consumed = 0;
+
+    if (!tag_len_) {
+        if (buf.empty()) {
+            return false;
+        }
+        if (buf[0] != '<') {
+            return next_text(buf, 0, token.data, consumed);
+        }
+
+        size_t i { 1 };
+        while (i < buf.size() && is_tag_char(buf[i])) {
+            ++i;
+        }
+        if (i == buf.size()) {
+            return false;
+        }
+        if (i == 1 || buf[i] != '>') {
+            /* no opening tag, '<' is part of the text */
+            return next_text(buf, 1, token.data, consumed);
+        }
+
+        tag_len_ = i - 1;
+        search_pos_ = i + 1;
+    }
+
+    const auto tag { buf.substr(1, tag_len_) };
+    const auto data_start { tag_len_ + 2 };
+    const auto close_len { tag_len_ + 5 }; // "</" tag ">\r\n"
+
+    while (true) {
+        const auto pos { buf.find("</", search_pos_) };
+        if (pos == std::string_view::npos) {
+            /* a trailing '<' could be the start of the closing tag */
+            search_pos_ = std::max(data_start, buf.size() ? buf.size() - 1 : 0);
+            break;
+        }
+        if (buf.size() < pos + close_len) {
+            search_pos_ = pos;
+            break;
+        }
+
+        if (pos > data_start && buf.compare(pos + 2, tag_len_, tag) == 0 && buf.compare(pos + 2 + tag_len_, 3, ">\r\n") == 0) {
+            token.tag = tag;
+            token.data = buf.substr(data_start, pos - data_start);
+            consumed = pos + close_len;
+            reset();
+            return true;
+        }
+
+        search_pos_ = pos + 1;
+    }
+
+    if (buf.size() > MAX_FRAME_SIZE_) {
+        /* give up on this frame, pass the opening tag on as plain text */
+        reset();
+        return next_text(buf, 1, token.data, consumed);
+    }
+
+    return false;
+}
@@ -0,0 +1,70 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    frame_tokenizer.h
+ * @brief   Streaming tokenizer for text based ct-Bot frames
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+
+/**
+ * @brief Splits a byte stream into "<tag>data</tag>\r\n" frames and plain text
+ *
+ * Works in linear time on a buffer that grows at the end. If a frame is split across reads, the tokenizer remembers the open tag and where the
+ * search for the closing tag stopped, so the next call continues from there instead of scanning the frame again.
+ */
+class FrameTokenizer {
+    static constexpr size_t MAX_FRAME_SIZE_ { 64 * 1024 }; /**< an open tag without closing tag within this size is treated as plain text */
+
+    size_t tag_len_; /**< length of the currently open tag, 0 if outside of a frame */
+    size_t search_pos_; /**< position to continue the search for the closing tag */
+
+    static bool is_tag_char(const char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    }
+
+    static bool next_text(const std::string_view& buf, const size_t from, std::string_view& text, size_t& consumed);
+
+public:
+    struct Token {
+        std::string_view tag; /**< tag of frame, empty for plain text */
+        std::string_view data; /**< content of frame or plain text */
+    };
+
+    FrameTokenizer() : tag_len_ {}, search_pos_ {} {}
+
+    /**
+     * @brief Get next token from buffer
+     * @param[in] buf: Buffer to tokenize, has to start at the same position as for the previous call, unless that call returned true
+     * @param[out] token: Next token, views into buf
+     * @param[out] consumed: Number of bytes to remove from the front of buf after the token was processed
+     * @return true, if a token was found; false, if more data is needed
+     */
+    bool next(const std::string_view& buf, Token& token, size_t& consumed);
+
+    void reset() {
+        tag_len_ = 0;
+        search_pos_ = 0;
+    }
+};
@@ -0,0 +1,99 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    latency_histogram.h
+ * @brief   Histogram of latencies with logarithmic buckets
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+
+/**
+ * @brief Counts latencies in buckets of powers of 2 microseconds
+ *
+ * Bucket 0 counts latencies below 2 us, bucket i counts latencies in [2^i us, 2^(i+1) us), the last bucket all longer ones.
+ */
+class LatencyHistogram {
+public:
+    static constexpr size_t BUCKETS_ { 24 };
+
+    LatencyHistogram() : buckets_ {}, count_ {}, max_ns_ {} {}
+
+    void add(const int64_t latency_ns) {
+        const auto us { static_cast<uint64_t>(latency_ns > 0 ? latency_ns : 0) / 1'000 };
+        const auto bucket { us < 2 ? 0 : static_cast<size_t>(std::bit_width(us) - 1) };
+        ++buckets_[bucket < BUCKETS_ ? bucket : BUCKETS_ - 1];
+        ++count_;
+        if (latency_ns > max_ns_) {
+            max_ns_ = latency_ns;
+        }
+    }
+
+    const auto& get_buckets() const {
+        return buckets_;
+    }
+
+    uint64_t get_count() const {
+        return count_;
+    }
+
+    int64_t get_max_ns() const {
+        return max_ns_;
+    }
+
+    /**
+     * @return Exclusive upper limit of a bucket in us
+     */
+    static constexpr int64_t get_limit_us(const size_t bucket) {
+        return int64_t { 2 } << bucket;
+    }
+
+    /**
+     * @param[in] quantile: Quantile in [0; 1]
+     * @return Upper limit in us of the bucket containing the given quantile or 0, if empty
+     */
+    int64_t get_percentile_us(const double quantile) const {
+        const auto target { static_cast<uint64_t>(quantile * static_cast<double>(count_)) };
+        uint64_t sum {};
+        for (size_t i {}; i < BUCKETS_; ++i) {
+            sum += buckets_[i];
+            if (sum > target || (sum == count_ && sum)) {
+                return get_limit_us(i);
+            }
+        }
+        return 0;
+    }
+
+    void reset() {
+        buckets_ = {};
+        count_ = 0;
+        max_ns_ = 0;
+    }
+
+private:
+    std::array<uint64_t, BUCKETS_> buckets_;
+    uint64_t count_;
+    int64_t max_ns_;
+};
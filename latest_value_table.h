@@ -0,0 +1,81 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    latest_value_table.h
+ * @brief   Lock-free table of the latest value per channel
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+
+/**
+ * @brief Latest value of each of N channels, written by one thread and collected by another
+ *
+ * Writing a channel overwrites its previous value and marks it as changed; collect() returns every changed channel once with its latest value.
+ * So the reader does work proportional to the number of channels, regardless of how often they were written.
+ * @tparam N: Number of channels
+ */
+template <size_t N>
+class LatestValueTable {
+    static constexpr size_t WORDS_ { (N + 63) / 64 };
+
+    std::array<std::atomic<uint32_t>, N> values_; /**< bit patterns of float values */
+    std::array<std::atomic<uint64_t>, WORDS_> changed_; /**< one bit per channel */
+
+public:
+    LatestValueTable() : values_ {}, changed_ {} {}
+
+    /**
+     * @brief Set value of a channel, writer only
+     * @param[in] channel: Number of channel, < N
+     * @param[in] value: New value
+     */
+    void store(const size_t channel, const float value) {
+        values_[channel].store(std::bit_cast<uint32_t>(value), std::memory_order_relaxed);
+        changed_[channel / 64].fetch_or(uint64_t { 1 } << (channel % 64), std::memory_order_release);
+    }
+
+    /**
+     * @brief Get all channels changed since the last call, reader only
+     * @param[in] func: Called with number of channel and latest value for each changed channel
+     */
+    template <typename F>
+    void collect(F&& func) {
+        for (size_t word {}; word < WORDS_; ++word) {
+            auto mask { changed_[word].exchange(0, std::memory_order_acquire) };
+            while (mask) {
+                const auto bit { static_cast<size_t>(std::countr_zero(mask)) };
+                mask &= mask - 1;
+                const auto channel { word * 64 + bit };
+                func(channel, std::bit_cast<float>(values_[channel].load(std::memory_order_relaxed)));
+            }
+        }
+    }
+
+    static constexpr size_t size() {
+        return N;
+    }
+};
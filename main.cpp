@@ -25,9 +25,12 @@
 #include <QGuiApplication>
 #include <QApplication>
 #include <QQmlApplicationEngine>
+#include <QQmlContext>
 #include <QQuickStyle>
 #include <QString>
 
+#include <memory>
+
 #include "connection_manager.h"
 #include "sensor_viewer.h"
 #include "actuator_viewer.h"
@@ -36,6 +39,7 @@
 #include "remotecall_viewer.h"
 #include "log_viewer.h"
 #include "map_viewer.h"
+#include "map_simulator.h"
 #include "script_editor.h"
 #include "bot_console.h"
 
@@ -48,6 +52,7 @@ int main(int argc, char* argv[]) {
 
     ConnectionManagerV1 connection_v1 { &engine };
     ConnectionManagerV2 connection_v2 { &engine };
+    connection_v1.set_require_crc(app.arguments().contains(QStringLiteral("--require-crc")));
 
     SensorViewerV1 sensor_viewer_v1 { &engine, connection_v1 };
     SensorViewerV2 sensor_viewer_v2 { &engine, connection_v2 };
@@ -60,9 +65,18 @@ int main(int argc, char* argv[]) {
     LogViewerV1 log_viewer_v1 { &engine, connection_v1 };
     LogViewerV2 log_viewer_v2 { &engine, connection_v2 };
     MapViewer map_viewer { &engine, connection_v1 };
-    ScriptEditor script_editor { &engine, connection_v1.get_socket() };
+    ScriptEditor script_editor { &engine, connection_v1 };
     BotConsole bot_console { &engine, connection_v2 };
 
+    /* local stand-in for a bot sending map data, to test the map viewer offline */
+    std::unique_ptr<MapSimulator> p_map_simulator;
+    if (app.arguments().contains(QStringLiteral("--map-simulator"))) {
+        p_map_simulator = std::make_unique<MapSimulator>();
+    }
+
+    /* render map with scene graph nodes instead of QQuickPaintedItem */
+    engine.rootContext()->setContextProperty(QStringLiteral("mapSceneGraph"), app.arguments().contains(QStringLiteral("--map-scenegraph")));
+
     const QUrl main_qlm { QStringLiteral("qrc:/Main.qml") };
     QObject::connect(&engine, &QQmlApplicationEngine::objectCreated, &app, [main_qlm](QObject* p_object, const QUrl& object_url) {
             if (!p_object && main_qlm == object_url) {
@@ -83,5 +97,11 @@ int main(int argc, char* argv[]) {
     script_editor.register_buttons();
     bot_console.register_buttons();
 
-    return app.exec();
+    const auto result { app.exec() };
+
+    /* decoders run in the I/O threads and write to the viewers, which are destroyed before the connections */
+    connection_v1.stop_io_thread();
+    connection_v2.stop_io_thread();
+
+    return result;
 }
@@ -0,0 +1,90 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    map_block_assembler.cpp
+ * @brief   Reassembly of map blocks from CMD_SUB_MAP_DATA_1..4
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "map_block_assembler.h"
+
+
+MapBlockAssembler::MapBlockAssembler() : entries_ {}, stats_ {} {}
+
+const MapBlockAssembler::Block* MapBlockAssembler::add(const uint16_t block, const size_t quarter, const uint8_t* data, const int64_t now_ms) {
+    if (quarter > 3) {
+        return nullptr;
+    }
+
+    expire(now_ms);
+
+    auto it { std::find_if(entries_.begin(), entries_.end(), [block](const Entry& e) { return e.received && e.block == block; }) };
+    if (it == entries_.end()) {
+        it = std::find_if(entries_.begin(), entries_.end(), [](const Entry& e) { return !e.received; });
+        if (it == entries_.end()) {
+            /* table full, evict least recently updated partial block */
+            it = std::min_element(entries_.begin(), entries_.end(), [](const Entry& a, const Entry& b) { return a.last_update < b.last_update; });
+            ++stats_.dropped;
+        }
+        it->block = block;
+        it->received = 0;
+    }
+
+    const uint8_t mask { static_cast<uint8_t>(1U << quarter) };
+    if (it->received & mask) {
+        ++stats_.duplicates;
+    } else if ((it->received & (mask - 1U)) != mask - 1U) {
+        ++stats_.out_of_order;
+    }
+
+    std::memcpy(it->data.data() + quarter * ctbot::MapBlockCodec::QUARTER_SIZE_, data, ctbot::MapBlockCodec::QUARTER_SIZE_);
+    it->received |= mask;
+    it->last_update = now_ms;
+
+    if (it->received != COMPLETE_) {
+        return nullptr;
+    }
+
+    ++stats_.completed;
+    it->received = 0;
+
+    return &it->data;
+}
+
+void MapBlockAssembler::clear() {
+    for (auto& e : entries_) {
+        e.received = 0;
+    }
+}
+
+size_t MapBlockAssembler::get_partial_count() const {
+    return static_cast<size_t>(std::count_if(entries_.begin(), entries_.end(), [](const Entry& e) { return e.received != 0; }));
+}
+
+void MapBlockAssembler::expire(const int64_t now_ms) {
+    for (auto& e : entries_) {
+        if (e.received && now_ms - e.last_update > EXPIRY_MS_) {
+            e.received = 0;
+            ++stats_.dropped;
+        }
+    }
+}
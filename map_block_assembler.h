@@ -0,0 +1,94 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    map_block_assembler.h
+ * @brief   Reassembly of map blocks from CMD_SUB_MAP_DATA_1..4
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "map_block_codec.h"
+
+
+/**
+ * @brief Small table of partially received map blocks
+ *
+ * The four quarters of a block may arrive in any order and interleaved with quarters of other blocks. A block is returned as soon as all of
+ * its quarters are present. Partial blocks not updated for EXPIRY_MS_ are dropped, as is the least recently updated one if the table is full.
+ */
+class MapBlockAssembler {
+public:
+    using Block = ctbot::MapBlockCodec::Block;
+
+    static constexpr size_t SLOTS_ { 8 };
+    static constexpr int64_t EXPIRY_MS_ { 2'000 };
+
+    struct Statistics {
+        uint64_t completed; /**< number of blocks completely received */
+        uint64_t out_of_order; /**< number of quarters received before a preceding quarter of the same block */
+        uint64_t duplicates; /**< number of quarters received more than once */
+        uint64_t dropped; /**< number of partial blocks expired or evicted */
+    };
+
+    MapBlockAssembler();
+
+    /**
+     * @brief Add a quarter of a block
+     * @param[in] block: Number of block
+     * @param[in] quarter: Number of quarter [0; 3]
+     * @param[in] data: Data of quarter, ctbot::MapBlockCodec::QUARTER_SIZE_ bytes
+     * @param[in] now_ms: Current time in ms, monotonic
+     * @return Pointer to complete block, valid until next call, or nullptr if the block is still incomplete
+     */
+    const Block* add(const uint16_t block, const size_t quarter, const uint8_t* data, const int64_t now_ms);
+
+    /**
+     * @brief Drop all partial blocks
+     */
+    void clear();
+
+    /**
+     * @return Number of blocks currently incomplete
+     */
+    size_t get_partial_count() const;
+
+    const auto& get_statistics() const {
+        return stats_;
+    }
+
+private:
+    struct Entry {
+        Block data;
+        int64_t last_update;
+        uint16_t block;
+        uint8_t received; /**< bitmask of received quarters, 0 if entry is unused */
+    };
+
+    static constexpr uint8_t COMPLETE_ { 0xf };
+
+    std::array<Entry, SLOTS_> entries_;
+    Statistics stats_;
+
+    void expire(const int64_t now_ms);
+};
@@ -0,0 +1,177 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    map_block_codec.h
+ * @brief   Encoding of map blocks for the delta map transfer
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+
+namespace ctbot {
+
+/**
+ * @brief Hash and run-length encoding of map blocks as used by CMD_SUB_MAP_DATA_RLE and CMD_SUB_MAP_DATA_SKIP and by map snapshots
+ *
+ * A map block consists of BLOCK_SIZE_ bytes as sent by CMD_SUB_MAP_DATA_1..4, that is 32 rows of ROW_SIZE_ cells. The run-length encoding is a
+ * sequence of (count, value) byte pairs with 1 <= count <= 255. The hash is 32 bit FNV-1a over the raw block data, it is transmitted in little endian
+ * byte order.
+ */
+class MapBlockCodec {
+public:
+    static constexpr size_t BLOCK_SIZE_ { 512 };
+    static constexpr size_t QUARTER_SIZE_ { BLOCK_SIZE_ / 4 };
+    static constexpr size_t ROW_SIZE_ { 16 };
+
+    using Block = std::array<uint8_t, BLOCK_SIZE_>;
+
+    static constexpr uint32_t hash(const uint8_t* data) {
+        uint32_t h { 2'166'136'261U };
+        for (size_t i {}; i < BLOCK_SIZE_; ++i) {
+            h = (h ^ data[i]) * 16'777'619U;
+        }
+        return h;
+    }
+
+    static constexpr uint32_t hash(const Block& block) {
+        return hash(block.data());
+    }
+
+    /**
+     * @brief Hash of a block never received, i.e. all cells unknown
+     */
+    static constexpr uint32_t empty_hash() {
+        return hash(Block {});
+    }
+
+    /**
+     * @brief Copy rows of a block to an 8 bit image, the signed cell values become pixel values by adding 128
+     * @param[in] data: First row to copy, ROW_SIZE_ bytes per row
+     * @param[out] p_dest: Pixel of the image to copy the first cell to
+     * @param[in] bytes_per_line: Distance of two rows of the image in byte
+     * @param[in] rows: Number of rows to copy
+     */
+    static void copy_rows(const uint8_t* data, uint8_t* p_dest, const size_t bytes_per_line, const size_t rows) {
+        static_assert(ROW_SIZE_ % sizeof(uint64_t) == 0);
+        constexpr uint64_t OFFSET_MASK { 0x8080'8080'8080'8080ULL }; // int8_t + 128 == uint8_t ^ 0x80
+
+        for (size_t j {}; j < rows; ++j) {
+            for (size_t i {}; i < ROW_SIZE_; i += sizeof(uint64_t)) {
+                uint64_t tmp;
+                std::memcpy(&tmp, data + i, sizeof(tmp));
+                tmp ^= OFFSET_MASK;
+                std::memcpy(p_dest + i, &tmp, sizeof(tmp));
+            }
+            data += ROW_SIZE_;
+            p_dest += bytes_per_line;
+        }
+    }
+
+    /**
+     * @brief Copy rows of a block back from an 8 bit image, inverse of copy_rows()
+     * @param[in] p_src: Pixel of the image to copy the first cell from
+     * @param[in] bytes_per_line: Distance of two rows of the image in byte
+     * @param[in] rows: Number of rows to copy
+     * @param[out] data: First row of the block, ROW_SIZE_ bytes per row
+     */
+    static void read_rows(const uint8_t* p_src, const size_t bytes_per_line, const size_t rows, uint8_t* data) {
+        /* the XOR of copy_rows() is its own inverse */
+        for (size_t j {}; j < rows; ++j) {
+            copy_rows(p_src, data, ROW_SIZE_, 1);
+            p_src += bytes_per_line;
+            data += ROW_SIZE_;
+        }
+    }
+
+    /**
+     * @brief Run-length encode data
+     * @param[in] data: Data to encode
+     * @param[in] size: Size of data in byte
+     * @param[out] out: Output buffer
+     * @param[in] capacity: Size of output buffer in byte
+     * @return Number of bytes written or 0, if the encoded data does not fit into the buffer
+     */
+    static size_t encode(const uint8_t* data, const size_t size, uint8_t* out, const size_t capacity) {
+        size_t n {};
+        for (size_t i {}; i < size;) {
+            size_t count { 1 };
+            while (i + count < size && count < 255 && data[i + count] == data[i]) {
+                ++count;
+            }
+            if (n + 2 > capacity) {
+                return 0;
+            }
+            out[n++] = static_cast<uint8_t>(count);
+            out[n++] = data[i];
+            i += count;
+        }
+
+        return n;
+    }
+
+    /**
+     * @brief Decode run-length encoded data
+     * @param[in] data: Encoded data
+     * @param[in] size: Size of encoded data in byte
+     * @param[out] out: Output buffer
+     * @param[in] out_size: Expected size of decoded data in byte
+     * @return true on success, false if the encoded data is malformed or does not decode to exactly out_size bytes
+     */
+    static bool decode(const uint8_t* data, const size_t size, uint8_t* out, const size_t out_size) {
+        if (size % 2) {
+            return false;
+        }
+
+        size_t n {};
+        for (size_t i {}; i < size; i += 2) {
+            const size_t count { data[i] };
+            if (!count || n + count > out_size) {
+                return false;
+            }
+            std::memset(out + n, data[i + 1], count);
+            n += count;
+        }
+
+        return n == out_size;
+    }
+
+    /**
+     * @brief Run-length encode a block
+     * @see encode(const uint8_t*, const size_t, uint8_t*, const size_t)
+     */
+    static size_t encode(const uint8_t* block, uint8_t* out, const size_t capacity) {
+        return encode(block, BLOCK_SIZE_, out, capacity);
+    }
+
+    /**
+     * @brief Decode a run-length encoded block
+     * @see decode(const uint8_t*, const size_t, uint8_t*, const size_t)
+     */
+    static bool decode(const uint8_t* data, const size_t size, Block& block) {
+        return decode(data, size, block.data(), BLOCK_SIZE_);
+    }
+};
+
+} /* namespace ctbot */
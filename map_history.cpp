@@ -0,0 +1,157 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    map_history.cpp
+ * @brief   History of map block changes
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#include <algorithm>
+#include <array>
+
+#include "map_history.h"
+
+
+MapHistory::MapHistory(const size_t blocks)
+    : blocks_ { blocks }, current_(blocks * ctbot::MapBlockCodec::BLOCK_SIZE_), first_seq_ {}, memory_ {}, budget_ { DEFAULT_BUDGET_ } {}
+
+void MapHistory::record(const int64_t timestamp, const uint16_t block, const Block& data) {
+    constexpr size_t BLOCK_SIZE { ctbot::MapBlockCodec::BLOCK_SIZE_ };
+    if (block >= blocks_) {
+        return;
+    }
+
+    if (keyframes_.empty() || timestamp - keyframes_.back().timestamp >= KEYFRAME_INTERVAL_MS_) {
+        add_keyframe(timestamp);
+    }
+
+    auto p_current { &current_[block * BLOCK_SIZE] };
+    Block diff;
+    for (size_t i {}; i < BLOCK_SIZE; ++i) {
+        diff[i] = p_current[i] ^ data[i];
+    }
+    std::copy(data.begin(), data.end(), p_current);
+
+    std::array<uint8_t, BLOCK_SIZE * 2> encoded;
+    const auto size { ctbot::MapBlockCodec::encode(diff.data(), encoded.data(), encoded.size()) };
+    auto& delta { deltas_.emplace_back(Delta { timestamp, block, std::vector<uint8_t>(encoded.begin(), encoded.begin() + static_cast<ptrdiff_t>(size)) }) };
+    memory_ += sizeof(Delta) + delta.diff.capacity();
+
+    enforce_budget();
+}
+
+void MapHistory::add_keyframe(const int64_t timestamp) {
+    constexpr size_t BLOCK_SIZE { ctbot::MapBlockCodec::BLOCK_SIZE_ };
+
+    Keyframe keyframe { timestamp, first_seq_ + deltas_.size(), {}, sizeof(Keyframe) };
+    std::array<uint8_t, BLOCK_SIZE * 2> encoded;
+    for (size_t block {}; block < blocks_; ++block) {
+        const auto p_data { &current_[block * BLOCK_SIZE] };
+        if (std::all_of(p_data, p_data + BLOCK_SIZE, [](const uint8_t v) { return v == 0; })) {
+            continue;
+        }
+
+        const auto size { ctbot::MapBlockCodec::encode(p_data, encoded.data(), encoded.size()) };
+        const auto& [nr, data] { keyframe.blocks.emplace_back(
+            static_cast<uint16_t>(block), std::vector<uint8_t>(encoded.begin(), encoded.begin() + static_cast<ptrdiff_t>(size))) };
+        keyframe.memory += sizeof(nr) + sizeof(data) + data.capacity();
+    }
+
+    memory_ += keyframe.memory;
+    keyframes_.emplace_back(std::move(keyframe));
+}
+
+void MapHistory::enforce_budget() {
+    /* keep at least one keyframe, so the history always starts with a complete state */
+    while (memory_ > budget_ && keyframes_.size() > 1) {
+        memory_ -= keyframes_.front().memory;
+        keyframes_.pop_front();
+
+        while (first_seq_ < keyframes_.front().first_delta) {
+            memory_ -= sizeof(Delta) + deltas_.front().diff.capacity();
+            deltas_.pop_front();
+            ++first_seq_;
+        }
+    }
+}
+
+void MapHistory::reconstruct(const int64_t timestamp, std::vector<uint8_t>& blocks) const {
+    constexpr size_t BLOCK_SIZE { ctbot::MapBlockCodec::BLOCK_SIZE_ };
+
+    if (keyframes_.empty() || timestamp >= get_end()) {
+        blocks = current_;
+        return;
+    }
+
+    /* start at last keyframe before timestamp */
+    auto it { std::upper_bound(keyframes_.begin(), keyframes_.end(), timestamp, [](const int64_t t, const Keyframe& k) { return t < k.timestamp; }) };
+    if (it != keyframes_.begin()) {
+        --it;
+    }
+
+    blocks.assign(current_.size(), 0);
+    for (const auto& [nr, data] : it->blocks) {
+        ctbot::MapBlockCodec::decode(data.data(), data.size(), &blocks[nr * BLOCK_SIZE], BLOCK_SIZE);
+    }
+
+    /* apply changes up to timestamp */
+    Block diff;
+    for (auto seq { it->first_delta }; seq < first_seq_ + deltas_.size(); ++seq) {
+        const auto& delta { deltas_[seq - first_seq_] };
+        if (delta.timestamp > timestamp) {
+            break;
+        }
+
+        ctbot::MapBlockCodec::decode(delta.diff.data(), delta.diff.size(), diff);
+        auto p_data { &blocks[delta.block * BLOCK_SIZE] };
+        for (size_t i {}; i < BLOCK_SIZE; ++i) {
+            p_data[i] ^= diff[i];
+        }
+    }
+}
+
+int64_t MapHistory::get_begin() const {
+    return keyframes_.empty() ? -1 : keyframes_.front().timestamp;
+}
+
+int64_t MapHistory::get_end() const {
+    return deltas_.empty() ? get_begin() : deltas_.back().timestamp;
+}
+
+double MapHistory::get_bytes_per_hour() const {
+    const auto duration { get_end() - get_begin() };
+    if (duration < 1'000) {
+        return 0.;
+    }
+
+    return static_cast<double>(memory_) * 3'600'000. / static_cast<double>(duration);
+}
+
+void MapHistory::set_budget(const size_t bytes) {
+    budget_ = bytes;
+    enforce_budget();
+}
+
+void MapHistory::clear() {
+    std::fill(current_.begin(), current_.end(), 0);
+    deltas_.clear();
+    keyframes_.clear();
+    first_seq_ = 0;
+    memory_ = 0;
+}
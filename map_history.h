@@ -0,0 +1,131 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    map_history.h
+ * @brief   History of map block changes
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <tuple>
+#include <vector>
+
+#include "map_block_codec.h"
+
+
+/**
+ * @brief Memory bounded history of all map block changes
+ *
+ * Every change of a block is stored as timestamp, block number and XOR difference to the previous content, run-length encoded. In addition, a
+ * keyframe with all non-empty blocks is stored every KEYFRAME_INTERVAL_MS_, so the state at any time is reconstructed from the preceding keyframe
+ * and the changes after it. If the memory budget is exceeded, the oldest keyframe and all changes up to the next keyframe are dropped.
+ */
+class MapHistory {
+public:
+    using Block = ctbot::MapBlockCodec::Block;
+
+    static constexpr size_t DEFAULT_BUDGET_ { 64 * 1024 * 1024 };
+    static constexpr int64_t KEYFRAME_INTERVAL_MS_ { 30'000 };
+
+    /**
+     * @param[in] blocks: Number of blocks of the map
+     */
+    MapHistory(const size_t blocks);
+
+    /**
+     * @brief Add a change of a block
+     * @param[in] timestamp: Time of change in ms, monotonic
+     * @param[in] block: Number of block
+     * @param[in] data: New content of block
+     */
+    void record(const int64_t timestamp, const uint16_t block, const Block& data);
+
+    /**
+     * @brief Reconstruct the map at a given time
+     * @param[in] timestamp: Time in ms, clamped to the recorded range
+     * @param[out] blocks: Content of all blocks, ctbot::MapBlockCodec::BLOCK_SIZE_ bytes each
+     */
+    void reconstruct(const int64_t timestamp, std::vector<uint8_t>& blocks) const;
+
+    /**
+     * @return Content of all blocks after the last change
+     */
+    const std::vector<uint8_t>& get_current() const {
+        return current_;
+    }
+
+    /**
+     * @return Time of oldest state available in ms or -1, if history is empty
+     */
+    int64_t get_begin() const;
+
+    /**
+     * @return Time of last change in ms or -1, if history is empty
+     */
+    int64_t get_end() const;
+
+    /**
+     * @return Memory used by changes and keyframes in byte
+     */
+    size_t get_memory_usage() const {
+        return memory_;
+    }
+
+    /**
+     * @return Memory used per hour of history in byte, extrapolated from the recorded range
+     */
+    double get_bytes_per_hour() const;
+
+    /**
+     * @brief Set memory budget, older history is dropped to meet it
+     * @param[in] bytes: Maximum memory to use in byte
+     */
+    void set_budget(const size_t bytes);
+
+    void clear();
+
+private:
+    struct Delta {
+        int64_t timestamp;
+        uint16_t block;
+        std::vector<uint8_t> diff; /**< run-length encoded XOR to previous content */
+    };
+
+    struct Keyframe {
+        int64_t timestamp;
+        uint64_t first_delta; /**< sequence number of first change after keyframe */
+        std::vector<std::tuple<uint16_t, std::vector<uint8_t>>> blocks; /**< run-length encoded non-empty blocks */
+        size_t memory;
+    };
+
+    size_t blocks_;
+    std::vector<uint8_t> current_;
+    std::deque<Delta> deltas_;
+    uint64_t first_seq_; /**< sequence number of deltas_.front() */
+    std::deque<Keyframe> keyframes_;
+    size_t memory_;
+    size_t budget_;
+
+    void add_keyframe(const int64_t timestamp);
+    void enforce_budget();
+};
@@ -23,67 +23,130 @@
  */
 
 #include "map_image.h"
+#include "map_block_codec.h"
+#include "map_snapshot.h"
 #include <QPainterPath>
 #include <QFile>
+#include <QUrl>
+
+#include <algorithm>
+#include <cstring>
 
 
 MapImageItem::MapImageItem(QQuickItem* parent)
     : QQuickPaintedItem { parent }, current_image_ { MAP_PIXEL_SIZE_, MAP_PIXEL_SIZE_, QImage::Format_Indexed8 },
-      min_ { MAP_PIXEL_SIZE_ / 2, MAP_PIXEL_SIZE_ / 2 }, max_ { MAP_PIXEL_SIZE_ / 2, MAP_PIXEL_SIZE_ / 2 }, p_update_timer_ {}, p_update_thread_ {},
-      needs_update_ {}, bot_pen_ { QColor { 255, 0, 0 } }, bot_brush_ { QColor { 255, 0, 0 }, Qt::SolidPattern } {
+      min_ { MAP_PIXEL_SIZE_ / 2, MAP_PIXEL_SIZE_ / 2 }, max_ { MAP_PIXEL_SIZE_ / 2, MAP_PIXEL_SIZE_ / 2 },
+      min_update_interval_ { DEFAULT_UPDATE_INTERVAL_MS_ }, last_refresh_ {}, refresh_pending_ {}, first_commit_ { -1 }, presented_commit_ { -1 },
+      commit_latency_ {}, bot_heading_ {}, tile_generations_ {}, overlay_generation_ {}, last_bot_heading_ {}, p_snapshot_thread_ {} {
     QVector<QRgb> table;
     for (int i {}; i < 256; ++i) {
         table.push_back(qRgb(i, i, i));
     }
     current_image_.setColorTable(table);
     current_image_.fill(128);
+    for (size_t i {}; i < MAP_MIP_LEVELS_; ++i) {
+        const int size { static_cast<int>(MAP_PIXEL_SIZE_ >> (i + 1)) };
+        mip_images_[i] = QImage { size, size, QImage::Format_Indexed8 };
+        mip_images_[i].setColorTable(table);
+        mip_images_[i].fill(128);
+    }
 
-    p_update_thread_ = new QThread { this };
-    p_update_timer_ = new QTimer { nullptr };
-    p_update_timer_->setInterval(100);
-    p_update_timer_->moveToThread(p_update_thread_);
-
-    connect(p_update_timer_, &QTimer::timeout, this, [this]() {
-        if (needs_update_) {
-            needs_update_ = false;
-            MapImageItem::update();
-        }
-    });
-    p_update_timer_->connect(p_update_thread_, SIGNAL(started()), SLOT(start()));
-    p_update_thread_->start();
+    clock_.start();
+    refresh_timer_.setSingleShot(true);
+    connect(&refresh_timer_, &QTimer::timeout, this, &MapImageItem::request_frame);
 }
 
 MapImageItem::~MapImageItem() {
-    p_update_thread_->quit();
-    p_update_timer_->deleteLater();
-    p_update_thread_->wait();
-    delete p_update_thread_;
+    if (p_snapshot_thread_) {
+        p_snapshot_thread_->wait();
+        delete p_snapshot_thread_;
+    }
 }
 
 void MapImageItem::paint(QPainter* painter) {
-    painter->drawImage(min_, current_image_, QRect(min_, max_));
+    /* item size is the map size times the zoom factor, everything below is painted in map pixels */
+    const qreal scale { width() / MAP_PIXEL_SIZE_ };
+    painter->scale(scale, scale);
 
-    for (auto& line : lines_) {
-        const QPen pen { std::get<1>(line) };
-        painter->setPen(pen);
-        painter->drawLine(std::get<0>(line));
+    /* only the area of the dirty tiles is repainted, everything else is kept by the render target */
+    const QRect area { (painter->hasClipping() ? painter->clipBoundingRect().toAlignedRect() : QRect { 0, 0, MAP_PIXEL_SIZE_, MAP_PIXEL_SIZE_ })
+        & map_rect() };
+    if (!area.isEmpty()) {
+        /* use the smallest level of the pyramid that still has at least one pixel per device pixel */
+        size_t level {};
+        while (level < MAP_MIP_LEVELS_ && scale * (1 << (level + 1)) <= 1.) {
+            ++level;
+        }
+
+        if (!level) {
+            painter->drawImage(area.topLeft(), current_image_, area);
+        } else {
+            update_mip_levels();
+            const int factor { 1 << level };
+            const QRect aligned { QPoint { area.left() & ~(factor - 1), area.top() & ~(factor - 1) },
+                QPoint { area.right() | (factor - 1), area.bottom() | (factor - 1) } };
+            const QRect source { aligned.left() / factor, aligned.top() / factor, aligned.width() / factor, aligned.height() / factor };
+            painter->drawImage(QRectF { aligned }, mip_images_[level - 1], QRectF { source });
+        }
+    }
+
+    paint_overlays(painter, *overlays_.snapshot(), bot_pos_, bot_heading_);
+}
+
+void MapImageItem::update_mip_levels() {
+    if (mip_dirty_tiles_.none()) {
+        return;
     }
 
-    for (auto& circle : circles_) {
-        const QPen pen { std::get<2>(circle) };
+    /* rebuild changed tiles only, each level as 2x2 average of the level above */
+    for (size_t i {}; i < mip_dirty_tiles_.size(); ++i) {
+        if (!mip_dirty_tiles_.test(i)) {
+            continue;
+        }
+
+        const auto rect { tile_rect(i) };
+        const QImage* p_source { &current_image_ };
+        for (size_t level {}; level < MAP_MIP_LEVELS_; ++level) {
+            auto& dest { mip_images_[level] };
+            const int size { static_cast<int>(MAP_TILE_SIZE_ >> (level + 1)) };
+            const int x { rect.x() >> (level + 1) };
+            const int y { rect.y() >> (level + 1) };
+            for (int row {}; row < size; ++row) {
+                const uchar* p_row0 { p_source->constScanLine((y + row) * 2) + x * 2 };
+                const uchar* p_row1 { p_source->constScanLine((y + row) * 2 + 1) + x * 2 };
+                uchar* p_dest { dest.scanLine(y + row) + x };
+                for (int col {}; col < size; ++col) {
+                    p_dest[col] = static_cast<uchar>((p_row0[col * 2] + p_row0[col * 2 + 1] + p_row1[col * 2] + p_row1[col * 2 + 1] + 2) / 4);
+                }
+            }
+            p_source = &dest;
+        }
+    }
+
+    mip_dirty_tiles_.reset();
+}
+
+void MapImageItem::paint_overlays(QPainter* painter, const MapOverlays::Snapshot& overlays, const QPoint& bot_pos, const unsigned bot_heading) {
+    /* one path and pen change per color; cosmetic pens keep lines one device pixel wide at any zoom */
+    painter->setBrush(Qt::NoBrush);
+    for (const auto& group : overlays) {
+        QPen pen { group.color };
+        pen.setCosmetic(true);
         painter->setPen(pen);
-        painter->drawEllipse(std::get<0>(circle), std::get<1>(circle), std::get<1>(circle));
+        painter->drawPath(group.path);
     }
 
-    if (!bot_pos_.isNull()) {
-        const QPointF pos { static_cast<qreal>(MAP_PIXEL_SIZE_ - bot_pos_.x()), static_cast<qreal>(MAP_PIXEL_SIZE_ - bot_pos_.y()) };
-        const QRectF rect { pos - QPointF { MAP_RESOULTION_ * 0.12 / 2., MAP_RESOULTION_ * 0.12 / 2. },
-            pos + QPointF { MAP_RESOULTION_ * 0.12 / 2., MAP_RESOULTION_ * 0.12 / 2. } };
+    if (!bot_pos.isNull()) {
+        const QColor bot_color { 255, 0, 0 };
+        const QPointF pos { static_cast<qreal>(MAP_PIXEL_SIZE_ - bot_pos.x()), static_cast<qreal>(MAP_PIXEL_SIZE_ - bot_pos.y()) };
+        const QRectF rect { pos - QPointF { BOT_MARKER_RADIUS_, BOT_MARKER_RADIUS_ }, pos + QPointF { BOT_MARKER_RADIUS_, BOT_MARKER_RADIUS_ } };
         QPainterPath path { pos };
-        path.arcTo(rect, bot_heading_ - 50., 280.);
+        path.arcTo(rect, bot_heading - 50., 280.);
 
-        painter->setBrush(bot_brush_);
-        painter->setPen(bot_pen_);
+        painter->setBrush(QBrush { bot_color, Qt::SolidPattern });
+        QPen pen { bot_color };
+        pen.setCosmetic(true);
+        painter->setPen(pen);
         painter->drawPath(path);
     }
 }
@@ -94,35 +157,40 @@ QImage MapImageItem::image() const {
 
 void MapImageItem::setImage(const QImage& image) {
     current_image_ = image;
+    mark_changed(QRect { 0, 0, MAP_PIXEL_SIZE_, MAP_PIXEL_SIZE_ });
     update();
 }
 
 void MapImageItem::clear() {
     current_image_.fill(128);
-    lines_.clear();
-    circles_.clear();
+    min_ = max_ = QPoint { MAP_PIXEL_SIZE_ / 2, MAP_PIXEL_SIZE_ / 2 };
+    overlays_.clear();
+    mark_changed(QRect { 0, 0, MAP_PIXEL_SIZE_, MAP_PIXEL_SIZE_ });
 }
 
 void MapImageItem::set_pixel(const size_t x, const size_t y, const uint8_t value) {
     current_image_.setPixel(x, y, value);
+    mark_changed(QRect { static_cast<int>(x), static_cast<int>(y), 1, 1 });
 }
 
 void MapImageItem::draw_line(const QPoint& from, const QPoint& to, const QColor& color) {
-    lines_.emplace_back(std::make_tuple(QLine { from, to }, color)); // FIXME: lock
+    mark_dirty(overlays_.add_line(QLine { from, to }, color));
 }
 
 void MapImageItem::draw_cicle(const QPoint& center, size_t radius, const QColor& color) {
-    circles_.emplace_back(std::make_tuple(center, radius, color)); // FIXME: lock
+    mark_dirty(overlays_.add_circle(center, radius, color));
 }
 
 void MapImageItem::clear_lines(const size_t remaining) {
-    const auto to_delete { lines_.size() <= remaining ? 0 : lines_.size() - remaining };
-    lines_.erase(lines_.begin(), lines_.begin() + to_delete);
+    mark_dirty(overlays_.remove_lines(remaining));
 }
 
 void MapImageItem::clear_circles(const size_t remaining) {
-    const auto to_delete { circles_.size() <= remaining ? 0 : circles_.size() - remaining };
-    circles_.erase(circles_.begin(), circles_.begin() + to_delete);
+    mark_dirty(overlays_.remove_circles(remaining));
+}
+
+void MapImageItem::set_overlay_capacity(const size_t capacity) {
+    mark_dirty(overlays_.set_capacity(capacity));
 }
 
 bool MapImageItem::save_to_file(const QString& filename) const {
@@ -137,32 +205,160 @@ bool MapImageItem::save_to_file(const QString& filename) const {
     return false;
 }
 
-void MapImageItem::update_map(const uint8_t* data, const size_t block, const size_t from, const size_t to) {
-    const auto x { ((block * (MAP_SECTION_SIZE_ * 2)) % MAP_MACROBLOCK_SIZE_ + (block / MAP_MACROBLOCK_SIZE_) * MAP_MACROBLOCK_SIZE_)
-        % MAP_PIXEL_SIZE_ }; // 2 sections per block in X orientation of map
-    const auto y { (((block / MAP_SECTION_SIZE_) * MAP_SECTION_SIZE_) % MAP_MACROBLOCK_SIZE_)
-        + (block / MAP_PIXEL_SIZE_) * MAP_MACROBLOCK_SIZE_ }; // 1 section per block in Y orientation of map
-
-    /* copy received data to map-image */
-    size_t pic_x {}, pic_y {};
-    size_t bufferIndex {};
-    for (size_t j { from }; j <= to && bufferIndex < (MAP_PIXEL_SIZE_ * MAP_PIXEL_SIZE_); ++j) { // rows
-        pic_y = x + j; // X of map is Y of viewer's coordinate system
-        if (pic_y >= static_cast<int>(MAP_PIXEL_SIZE_)) {
-            return; // invalid data
+bool MapImageItem::start_snapshot_thread(std::function<bool()>&& func) {
+    if (p_snapshot_thread_) {
+        return false;
+    }
+
+    p_snapshot_thread_ = QThread::create([this, func = std::move(func)]() {
+        QElapsedTimer timer;
+        timer.start();
+        const bool success { func() };
+        const int duration { static_cast<int>(timer.elapsed()) };
+
+        QMetaObject::invokeMethod(
+            this,
+            [this, success, duration]() {
+                p_snapshot_thread_->wait();
+                delete p_snapshot_thread_;
+                p_snapshot_thread_ = nullptr;
+                emit snapshotBusyChanged();
+                emit snapshotFinished(success, duration);
+            },
+            Qt::QueuedConnection);
+    });
+    p_snapshot_thread_->start();
+    emit snapshotBusyChanged();
+
+    return true;
+}
+
+bool MapImageItem::save_snapshot(const QString& filename) {
+    /* the worker gets shallow copies, changes of the map during saving detach them */
+    overlays_.publish();
+    return start_snapshot_thread([filename = QUrl { filename }.toLocalFile(), image = current_image_, bot_pos = bot_pos_, bot_heading = bot_heading_,
+                                     p_overlays = overlays_.snapshot()]() {
+        const bool success { MapSnapshot::save(filename, image, bot_pos, bot_heading, *p_overlays) };
+        if (!success) {
+            qDebug() << "MapImageItem::save_snapshot(" << filename << ") failed.";
         }
-        for (size_t i {}; i < MAP_SECTION_SIZE_; ++i) { // colums
-            pic_x = y + i; // Y of map is X of viewer's coordinate system
-            if (pic_x >= static_cast<int>(MAP_PIXEL_SIZE_)) {
-                return; // invalid data
-            }
-            /* calc gray value based on index table */
-            int8_t gray { static_cast<int8_t>(data[bufferIndex++]) };
-            const auto index { static_cast<int>(gray) + 128 };
-            current_image_.setPixel(pic_x, pic_y, static_cast<unsigned>(index));
+        return success;
+    });
+}
+
+void MapImageItem::reset() {
+    clear();
+    bot_pos_ = QPoint {};
+    bot_heading_ = 0;
+    commit();
+}
+
+bool MapImageItem::load_snapshot(const QString& filename) {
+    if (p_snapshot_thread_) {
+        return false;
+    }
+
+    reset();
+
+    return start_snapshot_thread([this, filename = QUrl { filename }.toLocalFile()]() {
+        /* tiles are applied batch by batch in the GUI thread, while the worker continues reading */
+        auto p_contents { std::make_shared<MapSnapshot::Contents>() };
+        const bool success { MapSnapshot::load(
+            filename, MAP_TILES_,
+            [this](std::vector<MapSnapshot::Tile>&& tiles) {
+                QMetaObject::invokeMethod(
+                    this,
+                    [this, tiles = std::move(tiles)]() {
+                        for (const auto& tile : tiles) {
+                            set_tile(tile.index, tile.data.data());
+                        }
+                        commit();
+                    },
+                    Qt::QueuedConnection);
+            },
+            *p_contents) };
+
+        if (success) {
+            QMetaObject::invokeMethod(
+                this,
+                [this, p_contents]() {
+                    bot_pos_ = p_contents->bot_pos;
+                    bot_heading_ = p_contents->bot_heading;
+                    for (const auto& [line, color] : p_contents->lines) {
+                        draw_line(line.p1(), line.p2(), color);
+                    }
+                    for (const auto& [center, radius, color] : p_contents->circles) {
+                        draw_cicle(center, radius, color);
+                    }
+                    commit();
+                },
+                Qt::QueuedConnection);
+        } else {
+            qDebug() << "MapImageItem::load_snapshot(" << filename << ") failed.";
+            /* drop the tiles of the broken snapshot that were applied already */
+            QMetaObject::invokeMethod(this, [this]() { reset(); }, Qt::QueuedConnection);
         }
+
+        return success;
+    });
+}
+
+void MapImageItem::set_tile(const size_t tile, const uint8_t* data) {
+    static_assert(MapSnapshot::TILE_SIZE_ == MAP_TILE_SIZE_);
+
+    if (tile >= MAP_TILES_ * MAP_TILES_) {
+        return;
+    }
+
+    const auto rect { tile_rect(tile) };
+    for (size_t row {}; row < MAP_TILE_SIZE_; ++row) {
+        std::memcpy(current_image_.scanLine(rect.y() + static_cast<int>(row)) + rect.x(), data + row * MAP_TILE_SIZE_, MAP_TILE_SIZE_);
+    }
+    mark_changed(rect);
+
+    /* extend area of received data like update_map() does, max_ is the start of the last block */
+    min_.setX(std::min(min_.x(), rect.left()));
+    min_.setY(std::min(min_.y(), rect.top()));
+    max_.setX(std::max(max_.x(), rect.right() - static_cast<int>(MAP_SECTION_SIZE_ - 1)));
+    max_.setY(std::max(max_.y(), rect.bottom() - static_cast<int>(MAP_SECTION_SIZE_ * 2 - 1)));
+}
+
+void MapImageItem::block_position(const size_t block, size_t& x, size_t& y) {
+    x = ((block * (MAP_SECTION_SIZE_ * 2)) % MAP_MACROBLOCK_SIZE_ + (block / MAP_MACROBLOCK_SIZE_) * MAP_MACROBLOCK_SIZE_)
+        % MAP_PIXEL_SIZE_; // 2 sections per block in X orientation of map
+    y = (((block / MAP_SECTION_SIZE_) * MAP_SECTION_SIZE_) % MAP_MACROBLOCK_SIZE_)
+        + (block / MAP_PIXEL_SIZE_) * MAP_MACROBLOCK_SIZE_; // 1 section per block in Y orientation of map
+}
+
+bool MapImageItem::read_block(const size_t block, uint8_t* data) const {
+    size_t x, y;
+    block_position(block, x, y);
+    if (x + MAP_SECTION_SIZE_ * 2 > MAP_PIXEL_SIZE_ || y + MAP_SECTION_SIZE_ > MAP_PIXEL_SIZE_) {
+        return false;
+    }
+
+    const auto bytes_per_line { static_cast<size_t>(current_image_.bytesPerLine()) };
+    ctbot::MapBlockCodec::read_rows(current_image_.constBits() + x * bytes_per_line + y, bytes_per_line, MAP_SECTION_SIZE_ * 2, data);
+
+    return true;
+}
+
+void MapImageItem::update_map(const uint8_t* data, const size_t block, const size_t from, const size_t to) {
+    size_t x, y;
+    block_position(block, x, y);
+
+    if (from > to || x + to >= MAP_PIXEL_SIZE_ || y + MAP_SECTION_SIZE_ > MAP_PIXEL_SIZE_) {
+        return; // invalid data
     }
 
+    /* copy received data to map-image, one row of a section at once; X of map is Y of viewer's coordinate system and vice versa */
+    static_assert(MAP_SECTION_SIZE_ == ctbot::MapBlockCodec::ROW_SIZE_);
+    const auto bytes_per_line { static_cast<size_t>(current_image_.bytesPerLine()) };
+    ctbot::MapBlockCodec::copy_rows(data, current_image_.bits() + (x + from) * bytes_per_line + y, bytes_per_line, to - from + 1);
+    size_t pic_x { y + MAP_SECTION_SIZE_ - 1 };
+    size_t pic_y { x + to };
+    mark_changed(QRect { QPoint { static_cast<int>(y), static_cast<int>(x + from) }, QPoint { static_cast<int>(pic_x), static_cast<int>(pic_y) } });
+
     /* round coordinates to block size */
     pic_x &= ~(MAP_SECTION_SIZE_ - 1);
     pic_y &= ~(MAP_SECTION_SIZE_ * 2 - 1); // 2 sections per block in X orientation of map
@@ -179,5 +375,165 @@ void MapImageItem::update_map(const uint8_t* data, const size_t block, const siz
 }
 
 void MapImageItem::commit() {
-    needs_update_ = true;
+    /* repaint old and new position of bot */
+    const auto bot { bot_rect() };
+    if (bot != last_bot_rect_ || bot_heading_ != last_bot_heading_) {
+        mark_dirty(last_bot_rect_);
+        mark_dirty(bot);
+        last_bot_rect_ = bot;
+        last_bot_heading_ = bot_heading_;
+        ++overlay_generation_;
+    }
+
+    if (first_commit_ < 0) {
+        first_commit_ = clock_.elapsed();
+    }
+    if (!refresh_pending_) {
+        refresh_pending_ = true;
+        const auto wait { last_refresh_ + min_update_interval_ - clock_.elapsed() };
+        if (wait > 0) {
+            refresh_timer_.start(static_cast<int>(wait));
+        } else {
+            request_frame();
+        }
+    }
+}
+
+void MapImageItem::setMinUpdateInterval(int ms) {
+    if (ms == min_update_interval_) {
+        return;
+    }
+
+    min_update_interval_ = std::max(ms, 0);
+    emit minUpdateIntervalChanged();
+}
+
+void MapImageItem::request_frame() {
+    if (window()) {
+        /* refresh() is called by after_animating() when the window prepares the requested frame */
+        window()->update();
+    } else {
+        refresh();
+    }
+}
+
+void MapImageItem::refresh() {
+    last_refresh_ = clock_.elapsed();
+    refresh_pending_ = false;
+    refresh_timer_.stop();
+
+    if (overlays_.publish()) {
+        ++overlay_generation_;
+    }
+    repaint_dirty();
+    emit mapChanged();
+
+    if (presented_commit_ < 0) {
+        presented_commit_ = first_commit_;
+    }
+    first_commit_ = -1;
+}
+
+void MapImageItem::after_animating() {
+    /* the window may render frames for other items before the update interval elapsed, the timer requests the frame for this item then */
+    if (refresh_pending_ && clock_.elapsed() - last_refresh_ >= min_update_interval_) {
+        refresh();
+    }
+}
+
+void MapImageItem::frame_swapped() {
+    if (presented_commit_ < 0) {
+        return;
+    }
+
+    commit_latency_ = static_cast<int>(clock_.elapsed() - presented_commit_);
+    presented_commit_ = -1;
+    emit commitLatencyChanged();
+}
+
+void MapImageItem::itemChange(ItemChange change, const ItemChangeData& value) {
+    if (change == ItemSceneChange) {
+        disconnect(after_animating_connection_);
+        disconnect(frame_swapped_connection_);
+        if (value.window) {
+            /* emitted by the GUI thread right before the scene graph is synchronized, so the repainted tiles are part of this frame */
+            after_animating_connection_ = connect(value.window, &QQuickWindow::afterAnimating, this, &MapImageItem::after_animating);
+            /* queued to GUI thread, frameSwapped() is emitted by the render thread */
+            frame_swapped_connection_ = connect(value.window, &QQuickWindow::frameSwapped, this, &MapImageItem::frame_swapped, Qt::QueuedConnection);
+        }
+        if (refresh_pending_ && !refresh_timer_.isActive()) {
+            /* the frame requested from the old window is gone, request a new one once the item is moved */
+            refresh_timer_.start(0);
+        }
+    }
+
+    QQuickPaintedItem::itemChange(change, value);
+}
+
+void MapImageItem::mark_dirty(const QRect& area) {
+    const QRect rect { area & QRect { 0, 0, MAP_PIXEL_SIZE_, MAP_PIXEL_SIZE_ } };
+    if (rect.isEmpty()) {
+        return;
+    }
+
+    const size_t first_x { rect.left() / MAP_TILE_SIZE_ };
+    const size_t last_x { rect.right() / MAP_TILE_SIZE_ };
+    const size_t first_y { rect.top() / MAP_TILE_SIZE_ };
+    const size_t last_y { rect.bottom() / MAP_TILE_SIZE_ };
+    for (size_t ty { first_y }; ty <= last_y; ++ty) {
+        for (size_t tx { first_x }; tx <= last_x; ++tx) {
+            dirty_tiles_.set(ty * MAP_TILES_ + tx);
+        }
+    }
+}
+
+void MapImageItem::mark_changed(const QRect& area) {
+    const QRect rect { area & QRect { 0, 0, MAP_PIXEL_SIZE_, MAP_PIXEL_SIZE_ } };
+    if (rect.isEmpty()) {
+        return;
+    }
+
+    for (size_t ty { rect.top() / MAP_TILE_SIZE_ }; ty <= rect.bottom() / MAP_TILE_SIZE_; ++ty) {
+        for (size_t tx { rect.left() / MAP_TILE_SIZE_ }; tx <= rect.right() / MAP_TILE_SIZE_; ++tx) {
+            ++tile_generations_[ty * MAP_TILES_ + tx];
+            mip_dirty_tiles_.set(ty * MAP_TILES_ + tx);
+        }
+    }
+    mark_dirty(rect);
+}
+
+void MapImageItem::repaint_dirty() {
+    if (dirty_tiles_.all()) {
+        update();
+    } else if (dirty_tiles_.any()) {
+        for (size_t i {}; i < dirty_tiles_.size(); ++i) {
+            if (dirty_tiles_.test(i)) {
+                /* one device pixel more, for the cosmetic pens of lines on the tile border */
+                update(to_item(tile_rect(i)).adjusted(-1, -1, 1, 1));
+            }
+        }
+    }
+
+    dirty_tiles_.reset();
+}
+
+QRect MapImageItem::to_item(const QRect& area) const {
+    const qreal scale { width() / MAP_PIXEL_SIZE_ };
+    return QRectF { area.x() * scale, area.y() * scale, area.width() * scale, area.height() * scale }.toAlignedRect();
+}
+
+QRect MapImageItem::map_rect() const {
+    /* max_ is rounded down to the start of the last block */
+    return QRect { min_, max_ + QPoint { MAP_SECTION_SIZE_ - 1, MAP_SECTION_SIZE_ * 2 - 1 } };
+}
+
+QRect MapImageItem::bot_rect() const {
+    if (bot_pos_.isNull()) {
+        return QRect {};
+    }
+
+    const QPoint pos { static_cast<int>(MAP_PIXEL_SIZE_) - bot_pos_.x(), static_cast<int>(MAP_PIXEL_SIZE_) - bot_pos_.y() };
+    const int r { static_cast<int>(BOT_MARKER_RADIUS_) + 2 };
+
+    return QRect { pos - QPoint { r, r }, pos + QPoint { r, r } };
 }
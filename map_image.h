@@ -25,9 +25,10 @@
 #pragma once
 
 #include <cstdint>
-#include <atomic>
-#include <deque>
-#include <tuple>
+#include <array>
+#include <bitset>
+#include <functional>
+#include <memory>
 
 #include <QQuickPaintedItem>
 #include <QQuickItem>
@@ -35,14 +36,22 @@
 #include <QImage>
 #include <QPoint>
 #include <QLine>
+#include <QRect>
 #include <QColor>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QQuickWindow>
 #include <QThread>
 
+#include "map_overlays.h"
+
 
 class MapImageItem : public QQuickPaintedItem {
     Q_OBJECT
     Q_PROPERTY(QImage image READ image WRITE setImage NOTIFY imageChanged)
+    Q_PROPERTY(int minUpdateInterval READ minUpdateInterval WRITE setMinUpdateInterval NOTIFY minUpdateIntervalChanged)
+    Q_PROPERTY(int commitLatency READ commitLatency NOTIFY commitLatencyChanged)
+    Q_PROPERTY(bool snapshotBusy READ snapshotBusy NOTIFY snapshotBusyChanged)
 
 public:
     static constexpr qreal MAP_SIZE_ { 12.288 };
@@ -50,8 +59,20 @@ public:
     static constexpr size_t MAP_SECTION_SIZE_ { 16 };
     static constexpr size_t MAP_MACROBLOCK_SIZE_ { 512 };
     static constexpr size_t MAP_PIXEL_SIZE_ { static_cast<size_t>(MAP_SIZE_ * MAP_RESOULTION_) };
+    static constexpr size_t MAP_TILE_SIZE_ { 64 };
+    static constexpr size_t MAP_TILES_ { MAP_PIXEL_SIZE_ / MAP_TILE_SIZE_ }; /**< per dimension */
+    static constexpr size_t MAP_MIP_LEVELS_ { 3 }; /**< downsampled by 2, 4 and 8 */
+
+    static constexpr qreal BOT_MARKER_RADIUS_ { MAP_RESOULTION_ * 0.12 / 2. };
+
+    static_assert(MAP_PIXEL_SIZE_ % MAP_TILE_SIZE_ == 0);
+    static_assert(MAP_TILE_SIZE_ % (MAP_SECTION_SIZE_ * 2) == 0);
+    static_assert(MAP_TILE_SIZE_ % (1 << MAP_MIP_LEVELS_) == 0);
+
+    static constexpr int DEFAULT_UPDATE_INTERVAL_MS_ { 33 };
 
     MapImageItem(QQuickItem* parent = nullptr);
+
     ~MapImageItem();
 
     void setImage(const QImage& image);
@@ -64,10 +85,34 @@ public:
 
     void update_map(const uint8_t* data, const size_t block, const size_t from, const size_t to);
 
+    /**
+     * @brief Copy a whole block back from the map image, inverse of update_map()
+     * @param[in] block: Index of block
+     * @param[out] data: Block data, MapBlockCodec::BLOCK_SIZE_ bytes
+     * @return false, if block is out of range
+     */
+    bool read_block(const size_t block, uint8_t* data) const;
+
     void clear();
 
+    /**
+     * @brief Schedule a refresh of all changes since the last commit with the next frame of the window, at most one refresh per minUpdateInterval
+     */
     Q_INVOKABLE void commit();
 
+    int minUpdateInterval() const {
+        return min_update_interval_;
+    }
+
+    void setMinUpdateInterval(int ms);
+
+    /**
+     * @return Time in ms from the first commit() of the last refresh until the frame showing it was presented
+     */
+    int commitLatency() const {
+        return commit_latency_;
+    }
+
     void set_bot_x(const uint16_t new_pos) {
         bot_pos_.setX(new_pos);
     }
@@ -90,24 +135,128 @@ public:
 
     bool save_to_file(const QString& filename) const;
 
+    /**
+     * @brief Save explored tiles, bot pose, lines and circles as map snapshot, in background
+     * @param[in] filename: Name or URL of file
+     * @return true, if saving was started; snapshotFinished() is emitted when done
+     */
+    bool save_snapshot(const QString& filename);
+
+    /**
+     * @brief Replace map by a map snapshot, in background; the tiles are shown while they are read, a failed load leaves an empty map
+     * @param[in] filename: Name or URL of file
+     * @return true, if loading was started; snapshotFinished() is emitted when done
+     */
+    bool load_snapshot(const QString& filename);
+
+    bool snapshotBusy() const {
+        return p_snapshot_thread_ != nullptr;
+    }
+
     QPoint get_bot_pos() const {
         return bot_pos_;
     }
 
+    unsigned get_bot_heading() const {
+        return bot_heading_;
+    }
+
+    /**
+     * @return Last published lines and circles, thread-safe
+     */
+    std::shared_ptr<const MapOverlays::Snapshot> get_overlays() const {
+        return overlays_.snapshot();
+    }
+
+    /**
+     * @brief Limit number of lines and circles, the oldest ones are dropped first
+     * @param[in] capacity: Maximum number of lines and of circles
+     */
+    void set_overlay_capacity(const size_t capacity);
+
+    /**
+     * @brief Draw lines, circles and bot marker
+     * @param[in] painter: Painter to use, coordinates are map pixels
+     * @param[in] overlays: Lines and circles to draw
+     * @param[in] bot_pos: Position of bot as set by set_bot_x() and set_bot_y(), no marker is drawn if null
+     * @param[in] bot_heading: Heading of bot in degree
+     */
+    static void paint_overlays(QPainter* painter, const MapOverlays::Snapshot& overlays, const QPoint& bot_pos, const unsigned bot_heading);
+
+    static QRect tile_rect(const size_t tile) {
+        return QRect { static_cast<int>((tile % MAP_TILES_) * MAP_TILE_SIZE_), static_cast<int>((tile / MAP_TILES_) * MAP_TILE_SIZE_), MAP_TILE_SIZE_,
+            MAP_TILE_SIZE_ };
+    }
+
+    /**
+     * @return Area of the map that contains received data
+     */
+    QRect map_rect() const;
+
+    /**
+     * @param[in] tile: Index of tile
+     * @return Counter incremented on each change of the map data of the tile
+     */
+    uint32_t get_tile_generation(const size_t tile) const {
+        return tile_generations_[tile];
+    }
+
+    /**
+     * @return Counter incremented on each change of lines, circles or bot marker
+     */
+    uint32_t get_overlay_generation() const {
+        return overlay_generation_;
+    }
+
 signals:
     void imageChanged();
+    void mapChanged();
+    void minUpdateIntervalChanged();
+    void commitLatencyChanged();
+    void snapshotBusyChanged();
+    void snapshotFinished(bool success, int milliseconds);
+
+protected:
+    void itemChange(ItemChange change, const ItemChangeData& value) override;
 
 private:
+    void request_frame();
+    void refresh();
+    void after_animating();
+    void frame_swapped();
+    void mark_dirty(const QRect& area);
+    void mark_changed(const QRect& area);
+    void repaint_dirty();
+    QRect bot_rect() const;
+    void set_tile(const size_t tile, const uint8_t* data);
+    void update_mip_levels();
+    QRect to_item(const QRect& area) const;
+    bool start_snapshot_thread(std::function<bool()>&& func);
+    static void block_position(const size_t block, size_t& x, size_t& y);
+    void reset();
+
     QImage current_image_;
     QPoint min_;
     QPoint max_;
-    QTimer* p_update_timer_;
-    QThread* p_update_thread_;
-    std::atomic<bool> needs_update_;
+    QTimer refresh_timer_;
+    QElapsedTimer clock_;
+    QMetaObject::Connection after_animating_connection_;
+    QMetaObject::Connection frame_swapped_connection_;
+    int min_update_interval_;
+    qint64 last_refresh_;
+    bool refresh_pending_;
+    qint64 first_commit_;
+    qint64 presented_commit_;
+    int commit_latency_;
     QPoint bot_pos_;
     unsigned bot_heading_;
-    const QPen bot_pen_;
-    const QBrush bot_brush_;
-    std::deque<std::tuple<QLine, QColor>> lines_;
-    std::deque<std::tuple<QPoint, size_t, QColor>> circles_;
+    MapOverlays overlays_;
+    std::bitset<MAP_TILES_ * MAP_TILES_> dirty_tiles_;
+    std::array<uint32_t, MAP_TILES_ * MAP_TILES_> tile_generations_;
+    std::array<QImage, MAP_MIP_LEVELS_> mip_images_; /**< map downsampled by 2^(i + 1) */
+    std::bitset<MAP_TILES_ * MAP_TILES_> mip_dirty_tiles_;
+    uint32_t overlay_generation_;
+    QRect last_bot_rect_;
+    unsigned last_bot_heading_;
+    QThread* p_snapshot_thread_;
 };
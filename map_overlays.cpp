@@ -0,0 +1,139 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    map_overlays.cpp
+ * @brief   Bounded store for lines and circles drawn over the map
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#include <map>
+
+#include "map_overlays.h"
+
+
+MapOverlays::MapOverlays()
+    : capacity_ { DEFAULT_CAPACITY_ }, dropped_ {}, changed_ {}, p_published_ { std::make_shared<const Snapshot>() } {}
+
+QRect MapOverlays::set_capacity(const size_t capacity) {
+    capacity_ = capacity;
+
+    return trim_lines(capacity_) | trim_circles(capacity_);
+}
+
+QRect MapOverlays::add_line(const QLine& line, const QColor& color) {
+    lines_.emplace_back(line, color);
+    changed_ = true;
+
+    if (lines_.size() > capacity_) {
+        ++dropped_;
+        return line_rect(line) | trim_lines(capacity_);
+    }
+
+    return line_rect(line);
+}
+
+QRect MapOverlays::add_circle(const QPoint& center, const size_t radius, const QColor& color) {
+    circles_.emplace_back(center, radius, color);
+    changed_ = true;
+
+    if (circles_.size() > capacity_) {
+        ++dropped_;
+        return circle_rect(center, radius) | trim_circles(capacity_);
+    }
+
+    return circle_rect(center, radius);
+}
+
+QRect MapOverlays::remove_lines(const size_t remaining) {
+    return trim_lines(remaining);
+}
+
+QRect MapOverlays::remove_circles(const size_t remaining) {
+    return trim_circles(remaining);
+}
+
+void MapOverlays::clear() {
+    lines_.clear();
+    circles_.clear();
+    changed_ = true;
+}
+
+QRect MapOverlays::trim_lines(const size_t max_size) {
+    QRect area;
+    while (lines_.size() > max_size) {
+        area |= line_rect(std::get<0>(lines_.front()));
+        lines_.pop_front();
+        changed_ = true;
+    }
+
+    return area;
+}
+
+QRect MapOverlays::trim_circles(const size_t max_size) {
+    QRect area;
+    while (circles_.size() > max_size) {
+        area |= circle_rect(std::get<0>(circles_.front()), std::get<1>(circles_.front()));
+        circles_.pop_front();
+        changed_ = true;
+    }
+
+    return area;
+}
+
+bool MapOverlays::publish() {
+    if (!changed_) {
+        return false;
+    }
+
+    /* group by color, in order of first appearance */
+    auto p_snapshot { std::make_shared<Snapshot>() };
+    std::map<QRgb, size_t> groups;
+    const auto get_group { [&p_snapshot, &groups](const QColor& color) -> Group& {
+        const auto [it, inserted] { groups.try_emplace(color.rgba(), p_snapshot->size()) };
+        if (inserted) {
+            p_snapshot->emplace_back().color = color;
+        }
+        return (*p_snapshot)[it->second];
+    } };
+
+    for (const auto& [line, color] : lines_) {
+        auto& group { get_group(color) };
+        group.lines.push_back(line);
+        group.path.moveTo(line.p1());
+        group.path.lineTo(line.p2());
+    }
+    for (const auto& [center, radius, color] : circles_) {
+        auto& group { get_group(color) };
+        group.circles.emplace_back(center, radius);
+        group.path.addEllipse(QPointF { center }, static_cast<qreal>(radius), static_cast<qreal>(radius));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock { mutex_ };
+        p_published_ = std::move(p_snapshot);
+    }
+    changed_ = false;
+
+    return true;
+}
+
+std::shared_ptr<const MapOverlays::Snapshot> MapOverlays::snapshot() const {
+    std::lock_guard<std::mutex> lock { mutex_ };
+    return p_published_;
+}
@@ -0,0 +1,136 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    map_overlays.h
+ * @brief   Bounded store for lines and circles drawn over the map
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#pragma once
+
+#include <QColor>
+#include <QLine>
+#include <QPainterPath>
+#include <QPoint>
+#include <QRect>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+
+/**
+ * @brief Double-buffered store for map overlays
+ *
+ * Lines and circles are added to a private buffer by the owning (GUI) thread. publish() converts this buffer into an immutable snapshot, grouped
+ * by color with one QPainterPath per color, that renderers can use from any thread without further locking. Only the exchange of the snapshot is
+ * protected by a mutex. Both lines and circles are limited to a configurable number of elements, the oldest ones are dropped first.
+ */
+class MapOverlays {
+public:
+    struct Group {
+        QColor color;
+        std::vector<QLine> lines;
+        std::vector<std::tuple<QPoint, size_t>> circles; /**< center, radius */
+        QPainterPath path; /**< all lines and circles of this group */
+    };
+
+    using Snapshot = std::vector<Group>;
+
+    static constexpr size_t DEFAULT_CAPACITY_ { 4'096 };
+
+    MapOverlays();
+
+    /**
+     * @brief Set maximum number of lines and of circles
+     * @param[in] capacity: Maximum number of elements per type
+     * @return Area of dropped elements
+     */
+    QRect set_capacity(const size_t capacity);
+
+    size_t get_capacity() const {
+        return capacity_;
+    }
+
+    size_t get_dropped() const {
+        return dropped_;
+    }
+
+    /**
+     * @return Area to repaint
+     */
+    QRect add_line(const QLine& line, const QColor& color);
+
+    /**
+     * @return Area to repaint
+     */
+    QRect add_circle(const QPoint& center, const size_t radius, const QColor& color);
+
+    /**
+     * @brief Remove the oldest lines
+     * @param[in] remaining: Number of (newest) lines to keep
+     * @return Area to repaint
+     */
+    QRect remove_lines(const size_t remaining);
+
+    /**
+     * @brief Remove the oldest circles
+     * @param[in] remaining: Number of (newest) circles to keep
+     * @return Area to repaint
+     */
+    QRect remove_circles(const size_t remaining);
+
+    void clear();
+
+    /**
+     * @brief Make all changes visible to snapshot()
+     * @return true, if a new snapshot was published
+     */
+    bool publish();
+
+    /**
+     * @return Last published state, thread-safe
+     */
+    std::shared_ptr<const Snapshot> snapshot() const;
+
+private:
+    static QRect line_rect(const QLine& line) {
+        return QRect { line.p1(), line.p2() }.normalized().adjusted(-1, -1, 1, 1);
+    }
+
+    static QRect circle_rect(const QPoint& center, const size_t radius) {
+        const int r { static_cast<int>(radius) + 1 };
+        return QRect { center - QPoint { r, r }, center + QPoint { r, r } };
+    }
+
+    QRect trim_lines(const size_t max_size);
+    QRect trim_circles(const size_t max_size);
+
+    std::deque<std::tuple<QLine, QColor>> lines_;
+    std::deque<std::tuple<QPoint, size_t, QColor>> circles_;
+    size_t capacity_;
+    size_t dropped_;
+    bool changed_;
+    mutable std::mutex mutex_;
+    std::shared_ptr<const Snapshot> p_published_;
+};
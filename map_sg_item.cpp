@@ -0,0 +1,301 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    map_sg_item.cpp
+ * @brief   Scene graph based renderer for map viewer
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#include <QQuickWindow>
+#include <QSGFlatColorMaterial>
+#include <QSGGeometryNode>
+#include <QSGImageNode>
+#include <QSGRenderNode>
+#include <QSGRendererInterface>
+#include <QSGTransformNode>
+#include <QMatrix4x4>
+#include <QPainter>
+
+#include <array>
+#include <cmath>
+#include <memory>
+#include <numbers>
+#include <vector>
+
+#include "map_sg_item.h"
+
+
+namespace {
+
+/**
+ * @brief Draws the overlays with QPainter, used with the software backend of the scene graph that does not support geometry nodes
+ */
+class OverlayPainterNode : public QSGRenderNode {
+    QQuickWindow* p_window_;
+    std::shared_ptr<const MapOverlays::Snapshot> p_overlays_;
+    QPoint bot_pos_;
+    unsigned bot_heading_;
+
+public:
+    OverlayPainterNode(QQuickWindow* p_window) : p_window_ { p_window }, p_overlays_ { std::make_shared<const MapOverlays::Snapshot>() }, bot_heading_ {} {}
+
+    void set_data(const MapImageItem& source) {
+        /* published overlays are immutable, render() may use them while the source is changed */
+        p_overlays_ = source.get_overlays();
+        bot_pos_ = source.get_bot_pos();
+        bot_heading_ = source.get_bot_heading();
+        markDirty(QSGNode::DirtyMaterial);
+    }
+
+    StateFlags changedStates() const override {
+        return {};
+    }
+
+    RenderingFlags flags() const override {
+        return BoundedRectRendering;
+    }
+
+    QRectF rect() const override {
+        return QRectF { 0., 0., MapImageItem::MAP_PIXEL_SIZE_, MapImageItem::MAP_PIXEL_SIZE_ };
+    }
+
+    void render(const RenderState* state) override {
+        auto p_painter { static_cast<QPainter*>(p_window_->rendererInterface()->getResource(p_window_, QSGRendererInterface::PainterResource)) };
+        if (!p_painter) {
+            return;
+        }
+
+        p_painter->save();
+        p_painter->setTransform(matrix()->toTransform());
+        p_painter->setOpacity(inheritedOpacity());
+        const QRegion* p_clip { state->clipRegion() };
+        if (p_clip && !p_clip->isEmpty()) {
+            p_painter->setClipRegion(*p_clip, Qt::ReplaceClip);
+        }
+        MapImageItem::paint_overlays(p_painter, *p_overlays_, bot_pos_, bot_heading_);
+        p_painter->restore();
+    }
+};
+
+
+class MapNode : public QSGTransformNode {
+    static constexpr size_t TILE_COUNT_ { MapImageItem::MAP_TILES_ * MapImageItem::MAP_TILES_ };
+    static constexpr int CIRCLE_SEGMENTS_ { 48 };
+    static constexpr int BOT_SEGMENTS_ { 24 };
+
+    QSGNode* p_tiles_;
+    QSGNode* p_overlays_;
+    OverlayPainterNode* p_overlay_painter_;
+    std::array<QSGImageNode*, TILE_COUNT_> tile_nodes_;
+    std::array<uint32_t, TILE_COUNT_> tile_generations_;
+    uint32_t overlay_generation_;
+    bool overlays_valid_;
+
+    static QSGGeometryNode* create_geometry_node(const std::vector<QPointF>& vertices, const unsigned int mode, const QColor& color) {
+        auto p_geometry { new QSGGeometry { QSGGeometry::defaultAttributes_Point2D(), static_cast<int>(vertices.size()) } };
+        p_geometry->setDrawingMode(mode);
+        p_geometry->setLineWidth(1.f);
+        auto p_vertex { p_geometry->vertexDataAsPoint2D() };
+        for (const auto& v : vertices) {
+            (p_vertex++)->set(static_cast<float>(v.x()), static_cast<float>(v.y()));
+        }
+
+        auto p_material { new QSGFlatColorMaterial };
+        p_material->setColor(color);
+
+        auto p_node { new QSGGeometryNode };
+        p_node->setGeometry(p_geometry);
+        p_node->setMaterial(p_material);
+        p_node->setFlags(QSGNode::OwnsGeometry | QSGNode::OwnsMaterial);
+
+        return p_node;
+    }
+
+    void build_overlays(const MapImageItem& source) {
+        while (auto p_child { p_overlays_->firstChild() }) {
+            p_overlays_->removeChildNode(p_child);
+            delete p_child;
+        }
+
+        /* lines and circles are drawn as line segments, one node per color */
+        const auto p_overlays { source.get_overlays() };
+        for (const auto& group : *p_overlays) {
+            std::vector<QPointF> vertices;
+            vertices.reserve(group.lines.size() * 2 + group.circles.size() * CIRCLE_SEGMENTS_ * 2);
+            for (const auto& line : group.lines) {
+                vertices.emplace_back(line.p1());
+                vertices.emplace_back(line.p2());
+            }
+            for (const auto& [center, radius] : group.circles) {
+                for (int i {}; i < CIRCLE_SEGMENTS_; ++i) {
+                    const auto a1 { 2. * std::numbers::pi * i / CIRCLE_SEGMENTS_ };
+                    const auto a2 { 2. * std::numbers::pi * (i + 1) / CIRCLE_SEGMENTS_ };
+                    vertices.emplace_back(center.x() + radius * std::cos(a1), center.y() + radius * std::sin(a1));
+                    vertices.emplace_back(center.x() + radius * std::cos(a2), center.y() + radius * std::sin(a2));
+                }
+            }
+            if (!vertices.empty()) {
+                p_overlays_->appendChildNode(create_geometry_node(vertices, QSGGeometry::DrawLines, group.color));
+            }
+        }
+
+        /* bot marker as filled circle sector, same shape as drawn by MapImageItem::paint_overlays() */
+        const auto bot_pos { source.get_bot_pos() };
+        if (!bot_pos.isNull()) {
+            const QPointF pos { static_cast<qreal>(MapImageItem::MAP_PIXEL_SIZE_ - bot_pos.x()),
+                static_cast<qreal>(MapImageItem::MAP_PIXEL_SIZE_ - bot_pos.y()) };
+            const auto start { (static_cast<qreal>(source.get_bot_heading()) - 50.) * std::numbers::pi / 180. };
+            const auto span { 280. * std::numbers::pi / 180. };
+            const auto r { MapImageItem::BOT_MARKER_RADIUS_ };
+
+            std::vector<QPointF> vertices;
+            vertices.reserve(BOT_SEGMENTS_ * 3);
+            for (int i {}; i < BOT_SEGMENTS_; ++i) {
+                /* angles are counter-clockwise with y pointing downwards, like QPainterPath::arcTo() */
+                const auto a1 { start + span * i / BOT_SEGMENTS_ };
+                const auto a2 { start + span * (i + 1) / BOT_SEGMENTS_ };
+                vertices.emplace_back(pos);
+                vertices.emplace_back(pos.x() + r * std::cos(a1), pos.y() - r * std::sin(a1));
+                vertices.emplace_back(pos.x() + r * std::cos(a2), pos.y() - r * std::sin(a2));
+            }
+            p_overlays_->appendChildNode(create_geometry_node(vertices, QSGGeometry::DrawTriangles, QColor { 255, 0, 0 }));
+        }
+    }
+
+public:
+    MapNode(QQuickWindow* p_window, const bool software)
+        : p_tiles_ { new QSGNode }, p_overlays_ { new QSGNode }, p_overlay_painter_ {}, tile_nodes_ {}, tile_generations_ {}, overlay_generation_ {},
+          overlays_valid_ {} {
+        appendChildNode(p_tiles_);
+        appendChildNode(p_overlays_);
+        if (software) {
+            p_overlay_painter_ = new OverlayPainterNode { p_window };
+            p_overlays_->appendChildNode(p_overlay_painter_);
+        }
+    }
+
+    void update_tiles(QQuickWindow* p_window, const MapImageItem& source) {
+        const auto area { source.map_rect() };
+        const auto image { source.image() };
+
+        for (size_t i {}; i < TILE_COUNT_; ++i) {
+            const auto tile { MapImageItem::tile_rect(i) };
+            const auto visible { tile & area };
+            auto& p_node { tile_nodes_[i] };
+
+            if (visible.isEmpty()) {
+                if (p_node) {
+                    p_tiles_->removeChildNode(p_node);
+                    delete p_node;
+                    p_node = nullptr;
+                }
+                continue;
+            }
+
+            const auto generation { source.get_tile_generation(i) };
+            if (!p_node) {
+                p_node = p_window->createImageNode();
+                p_node->setOwnsTexture(true);
+                p_node->setFiltering(QSGTexture::Nearest);
+                p_tiles_->appendChildNode(p_node);
+            } else if (tile_generations_[i] == generation) {
+                p_node->setRect(visible);
+                p_node->setSourceRect(visible.translated(-tile.topLeft()));
+                continue;
+            }
+
+            /* (re-)upload changed tile only */
+            p_node->setTexture(p_window->createTextureFromImage(image.copy(tile)));
+            p_node->setRect(visible);
+            p_node->setSourceRect(visible.translated(-tile.topLeft()));
+            tile_generations_[i] = generation;
+        }
+    }
+
+    void update_overlays(const MapImageItem& source) {
+        if (overlays_valid_ && overlay_generation_ == source.get_overlay_generation()) {
+            return;
+        }
+
+        if (p_overlay_painter_) {
+            p_overlay_painter_->set_data(source);
+        } else {
+            build_overlays(source);
+        }
+        overlay_generation_ = source.get_overlay_generation();
+        overlays_valid_ = true;
+    }
+};
+
+} // namespace
+
+
+MapSGItem::MapSGItem(QQuickItem* parent) : QQuickItem { parent }, p_source_ {} {
+    setFlag(ItemHasContents, true);
+}
+
+MapImageItem* MapSGItem::source() const {
+    return p_source_;
+}
+
+void MapSGItem::setSource(MapImageItem* p_source) {
+    if (p_source == p_source_) {
+        return;
+    }
+
+    if (p_source_) {
+        p_source_->disconnect(this);
+    }
+
+    p_source_ = p_source;
+
+    if (p_source_) {
+        connect(p_source_, &MapImageItem::mapChanged, this, &QQuickItem::update);
+        connect(p_source_, &QObject::destroyed, this, [this]() {
+            p_source_ = nullptr;
+            update();
+        });
+    }
+
+    emit sourceChanged();
+    update();
+}
+
+QSGNode* MapSGItem::updatePaintNode(QSGNode* p_old_node, UpdatePaintNodeData*) {
+    auto p_node { static_cast<MapNode*>(p_old_node) };
+    if (!p_source_) {
+        delete p_node;
+        return nullptr;
+    }
+
+    if (!p_node) {
+        const bool software { window()->rendererInterface()->graphicsApi() == QSGRendererInterface::Software };
+        p_node = new MapNode { window(), software };
+    }
+
+    /* map pixels to item coordinates, so zooming the item just changes this transformation */
+    QMatrix4x4 matrix;
+    matrix.scale(static_cast<float>(width() / MapImageItem::MAP_PIXEL_SIZE_), static_cast<float>(height() / MapImageItem::MAP_PIXEL_SIZE_));
+    p_node->setMatrix(matrix);
+
+    p_node->update_tiles(window(), *p_source_);
+    p_node->update_overlays(*p_source_);
+
+    return p_node;
+}
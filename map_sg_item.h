@@ -0,0 +1,57 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    map_sg_item.h
+ * @brief   Scene graph based renderer for map viewer
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#pragma once
+
+#include <QQuickItem>
+
+#include "map_image.h"
+
+
+/**
+ * @brief Renders the map data of a MapImageItem with scene graph nodes
+ *
+ * The map is kept as one texture per tile of the source, only tiles changed since the last frame are uploaded again. Lines, circles and the bot
+ * marker are drawn as geometry nodes, or by a QPainter based render node if the software backend of the scene graph is used.
+ */
+class MapSGItem : public QQuickItem {
+    Q_OBJECT
+    Q_PROPERTY(MapImageItem* source READ source WRITE setSource NOTIFY sourceChanged)
+
+public:
+    MapSGItem(QQuickItem* parent = nullptr);
+
+    MapImageItem* source() const;
+
+    void setSource(MapImageItem* p_source);
+
+signals:
+    void sourceChanged();
+
+protected:
+    QSGNode* updatePaintNode(QSGNode* p_old_node, UpdatePaintNodeData*) override;
+
+private:
+    MapImageItem* p_source_;
+};
@@ -0,0 +1,237 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    map_simulator.cpp
+ * @brief   Local stand-in for a bot sending map data
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#include <QDebug>
+#include <QHostAddress>
+#include <QTcpSocket>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numbers>
+#include <string_view>
+
+#include "map_simulator.h"
+#include "map_block_codec.h"
+
+
+MapSimulator::MapSimulator(const quint16 port)
+    : p_client_ {}, map_(MAP_BLOCKS_ * ctbot::MapBlockCodec::BLOCK_SIZE_), block_generations_(MAP_BLOCKS_), generation_ {}, step_ {},
+      bot_x_ { MAP_SIZE_ / 2 }, bot_y_ { MAP_SIZE_ / 2 }, bot_heading_ {} {
+    static_assert(static_cast<size_t>(MAP_SIZE_) * MAP_SIZE_ / ctbot::MapBlockCodec::BLOCK_SIZE_ == MAP_BLOCKS_);
+
+    QObject::connect(&server_, &QTcpServer::newConnection, &server_, [this]() {
+        auto p_socket { server_.nextPendingConnection() };
+        if (p_client_) {
+            p_socket->close();
+            p_socket->deleteLater();
+            return;
+        }
+
+        p_client_ = p_socket;
+        in_buffer_.clear();
+        QObject::connect(p_client_, &QTcpSocket::readyRead, &server_, [this]() { process_incoming(); });
+        QObject::connect(p_client_, &QTcpSocket::disconnected, &server_, [this]() {
+            p_client_->deleteLater();
+            p_client_ = nullptr;
+        });
+    });
+
+    QObject::connect(&tick_timer_, &QTimer::timeout, &server_, [this]() { tick(); });
+    tick_timer_.start(TICK_MS_);
+
+    if (!server_.listen(QHostAddress::LocalHost, port)) {
+        qWarning() << "MapSimulator: listening on port" << port << "failed:" << server_.errorString();
+    }
+}
+
+void MapSimulator::tick() {
+    /* drive on a closed curve through the room */
+    ++step_;
+    const double t { step_ * TICK_MS_ / 1'000. * 0.2 };
+    const double center { (ROOM_MIN_ + ROOM_MAX_) / 2. };
+    const double range { (ROOM_MAX_ - ROOM_MIN_) / 2. - SENSOR_RANGE_ };
+    const int x { static_cast<int>(center + range * std::sin(t)) };
+    const int y { static_cast<int>(center + range * std::sin(t * 0.7 + 1.)) };
+    if (x != bot_x_ || y != bot_y_) {
+        bot_heading_ = static_cast<int>(std::lround(std::atan2(y - bot_y_, x - bot_x_) * 180. / std::numbers::pi + 360.)) % 360;
+    }
+    bot_x_ = x;
+    bot_y_ = y;
+
+    /* cells within sensor range become more likely free, the walls of the room become obstacles */
+    ++generation_;
+    for (int i { -SENSOR_RANGE_ }; i <= SENSOR_RANGE_; ++i) {
+        for (int j { -SENSOR_RANGE_ }; j <= SENSOR_RANGE_; ++j) {
+            if (i * i + j * j > SENSOR_RANGE_ * SENSOR_RANGE_) {
+                continue;
+            }
+            const int cx { bot_x_ + i };
+            const int cy { bot_y_ + j };
+            if (cx < ROOM_MIN_ || cx > ROOM_MAX_ || cy < ROOM_MIN_ || cy > ROOM_MAX_) {
+                continue;
+            }
+
+            const bool wall { cx < ROOM_MIN_ + 8 || cx > ROOM_MAX_ - 8 || cy < ROOM_MIN_ + 8 || cy > ROOM_MAX_ - 8 };
+            const auto old_value { static_cast<int8_t>(map_[get_index(cx, cy)]) };
+            set_cell(cx, cy, wall ? int8_t { -128 } : static_cast<int8_t>(std::min(old_value + 8, 127)));
+        }
+    }
+}
+
+size_t MapSimulator::get_block(const int x, const int y) {
+    /* inverse of the block layout decoded by MapImageItem::update_map(): x is the row, y the column of the map image */
+    return static_cast<size_t>(((y / 512) * 3 + x / 512) * 512 + ((y % 512) / 16) * 16 + (x % 512) / 32);
+}
+
+size_t MapSimulator::get_index(const int x, const int y) {
+    return get_block(x, y) * ctbot::MapBlockCodec::BLOCK_SIZE_ + static_cast<size_t>((x % 32) * 16 + y % 16);
+}
+
+void MapSimulator::set_cell(const int x, const int y, const int8_t value) {
+    auto& cell { map_[get_index(x, y)] };
+    if (cell != static_cast<uint8_t>(value)) {
+        cell = static_cast<uint8_t>(value);
+        block_generations_[get_block(x, y)] = generation_;
+    }
+}
+
+void MapSimulator::process_incoming() {
+    in_buffer_.append(p_client_->readAll());
+
+    std::string_view buf { in_buffer_.constData(), static_cast<size_t>(in_buffer_.size()) };
+    while (true) {
+        ctbot::CommandView cmd;
+        size_t consumed {};
+        const auto status { ctbot::CommandNoCRC::try_parse(buf, cmd, consumed) };
+        buf.remove_prefix(consumed);
+        if (status == ctbot::ParseStatus::NEED_MORE_DATA) {
+            break;
+        }
+        if (status != ctbot::ParseStatus::OK || cmd.header.command != static_cast<uint8_t>(ctbot::CommandCodes::CMD_MAP)) {
+            continue;
+        }
+
+        switch (static_cast<ctbot::CommandCodes>(cmd.header.subcommand)) {
+            case ctbot::CommandCodes::CMD_SUB_MAP_REQUEST: send_map(); break;
+
+            case ctbot::CommandCodes::CMD_SUB_MAP_DELTA_REQUEST:
+                send_delta(static_cast<uint16_t>(cmd.header.data_l) | static_cast<uint32_t>(static_cast<uint16_t>(cmd.header.data_r)) << 16);
+                break;
+
+            default: break;
+        }
+    }
+    in_buffer_.remove(0, in_buffer_.size() - static_cast<int>(buf.size()));
+}
+
+void MapSimulator::send(const ctbot::CommandCodes& subcmd, const int16_t data_l, const int16_t data_r, const void* payload, const size_t size) {
+    ctbot::CommandNoCRC cmd { ctbot::CommandCodes::CMD_MAP, subcmd, data_l, data_r, ctbot::CommandBase::ADDR_NOT_SET, ctbot::CommandBase::ADDR_SIM };
+    if (size) {
+        cmd.add_payload(payload, size);
+    }
+
+    p_client_->write(reinterpret_cast<const char*>(&cmd.get_cmd()), sizeof(ctbot::CommandData));
+    if (size) {
+        p_client_->write(reinterpret_cast<const char*>(cmd.get_payload().data()), static_cast<qint64>(cmd.get_payload_size()));
+    }
+}
+
+void MapSimulator::send_block(const size_t block) {
+    constexpr size_t QUARTER_SIZE { ctbot::MapBlockCodec::QUARTER_SIZE_ };
+    const auto p_data { &map_[block * ctbot::MapBlockCodec::BLOCK_SIZE_] };
+    const auto block_nr { static_cast<int16_t>(block) };
+
+    send(ctbot::CommandCodes::CMD_SUB_MAP_DATA_1, block_nr, static_cast<int16_t>(bot_x_), p_data, QUARTER_SIZE);
+    send(ctbot::CommandCodes::CMD_SUB_MAP_DATA_2, block_nr, static_cast<int16_t>(bot_y_), p_data + QUARTER_SIZE, QUARTER_SIZE);
+    send(ctbot::CommandCodes::CMD_SUB_MAP_DATA_3, block_nr, static_cast<int16_t>(bot_heading_), p_data + 2 * QUARTER_SIZE, QUARTER_SIZE);
+    send(ctbot::CommandCodes::CMD_SUB_MAP_DATA_4, block_nr, 0, p_data + 3 * QUARTER_SIZE, QUARTER_SIZE);
+}
+
+void MapSimulator::send_map() {
+    if (!p_client_) {
+        return;
+    }
+
+    for (size_t block {}; block < MAP_BLOCKS_; ++block) {
+        if (block_generations_[block]) {
+            send_block(block);
+        }
+    }
+}
+
+void MapSimulator::send_delta(const uint32_t since) {
+    if (!p_client_) {
+        return;
+    }
+
+    std::array<uint8_t, ctbot::CommandBase::MAX_PAYLOAD> buffer;
+    size_t skip_first {};
+    size_t skip_count {};
+    const auto flush_skip { [&]() {
+        if (skip_count) {
+            send(ctbot::CommandCodes::CMD_SUB_MAP_DATA_SKIP, static_cast<int16_t>(skip_first), static_cast<int16_t>(skip_count), buffer.data(),
+                skip_count * sizeof(uint32_t));
+            skip_count = 0;
+        }
+    } };
+
+    for (size_t block {}; block < MAP_BLOCKS_; ++block) {
+        const auto generation { block_generations_[block] };
+        if (!generation) {
+            flush_skip();
+            continue;
+        }
+
+        const auto p_data { &map_[block * ctbot::MapBlockCodec::BLOCK_SIZE_] };
+        if (generation <= since) {
+            /* unchanged, report hash only */
+            if (!skip_count) {
+                skip_first = block;
+            }
+            const auto hash { ctbot::MapBlockCodec::hash(p_data) };
+            for (size_t i {}; i < sizeof(hash); ++i) {
+                buffer[skip_count * sizeof(hash) + i] = static_cast<uint8_t>(hash >> (i * 8));
+            }
+            if (++skip_count == SKIP_HASHES_MAX_) {
+                flush_skip();
+            }
+            continue;
+        }
+
+        flush_skip();
+        const auto size { ctbot::MapBlockCodec::encode(p_data, buffer.data(), buffer.size()) };
+        if (size) {
+            send(ctbot::CommandCodes::CMD_SUB_MAP_DATA_RLE, static_cast<int16_t>(block), 0, buffer.data(), size);
+        } else {
+            send_block(block);
+        }
+    }
+    flush_skip();
+
+    const std::array<uint8_t, 6> pose { static_cast<uint8_t>(bot_x_), static_cast<uint8_t>(bot_x_ >> 8), static_cast<uint8_t>(bot_y_),
+        static_cast<uint8_t>(bot_y_ >> 8), static_cast<uint8_t>(bot_heading_), static_cast<uint8_t>(bot_heading_ >> 8) };
+    send(ctbot::CommandCodes::CMD_SUB_MAP_DELTA_DONE, static_cast<int16_t>(generation_ & 0xffff), static_cast<int16_t>(generation_ >> 16), pose.data(),
+        pose.size());
+}
@@ -0,0 +1,88 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    map_simulator.h
+ * @brief   Local stand-in for a bot sending map data
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QTcpServer>
+#include <QTimer>
+
+#include <cstdint>
+#include <vector>
+
+#include "command.h"
+
+
+class QTcpSocket;
+
+/**
+ * @brief Minimal bot simulation speaking the CMD_MAP sub-protocol, to test the map viewer without a bot or c't-Sim
+ *
+ * Listens for one V1 connection. A bot drives through a rectangular room and explores the cells around it, every map change increases the
+ * map generation. CMD_SUB_MAP_REQUEST is answered with all explored blocks as CMD_SUB_MAP_DATA_1..4, CMD_SUB_MAP_DELTA_REQUEST with the
+ * blocks changed since the requested generation (run-length encoded where possible), the hashes of all other explored blocks and
+ * CMD_SUB_MAP_DELTA_DONE.
+ */
+class MapSimulator {
+public:
+    static constexpr quint16 DEFAULT_PORT_ { 10'002 };
+
+    MapSimulator(const quint16 port = DEFAULT_PORT_);
+
+    bool is_listening() const {
+        return server_.isListening();
+    }
+
+private:
+    static constexpr int MAP_SIZE_ { 1'536 };
+    static constexpr size_t MAP_BLOCKS_ { 4'608 };
+    static constexpr int TICK_MS_ { 100 };
+    static constexpr int SENSOR_RANGE_ { 48 };
+    static constexpr int ROOM_MIN_ { 256 };
+    static constexpr int ROOM_MAX_ { 1'280 };
+    static constexpr size_t SKIP_HASHES_MAX_ { ctbot::CommandBase::MAX_PAYLOAD / sizeof(uint32_t) };
+
+    QTcpServer server_;
+    QTcpSocket* p_client_;
+    QByteArray in_buffer_;
+    QTimer tick_timer_;
+    std::vector<uint8_t> map_; /**< blocks as sent, cell values are int8_t */
+    std::vector<uint32_t> block_generations_; /**< generation of last change per block, 0 if never explored */
+    uint32_t generation_;
+    uint32_t step_;
+    int bot_x_;
+    int bot_y_;
+    int bot_heading_;
+
+    static size_t get_block(const int x, const int y);
+    static size_t get_index(const int x, const int y);
+
+    void tick();
+    void set_cell(const int x, const int y, const int8_t value);
+    void process_incoming();
+    void send(const ctbot::CommandCodes& subcmd, const int16_t data_l, const int16_t data_r, const void* payload = nullptr, const size_t size = 0);
+    void send_block(const size_t block);
+    void send_map();
+    void send_delta(const uint32_t since);
+};
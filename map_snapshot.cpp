@@ -0,0 +1,177 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    map_snapshot.cpp
+ * @brief   Native file format for maps
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <cstring>
+
+#include "map_snapshot.h"
+#include "map_block_codec.h"
+
+
+bool MapSnapshot::save(
+    const QString& filename, const QImage& image, const QPoint& bot_pos, const unsigned bot_heading, const MapOverlays::Snapshot& overlays) {
+    if (image.format() != QImage::Format_Indexed8 || image.width() != image.height() || image.width() % TILE_SIZE_) {
+        return false;
+    }
+
+    const size_t tiles_per_dim { static_cast<size_t>(image.width()) / TILE_SIZE_ };
+    std::vector<uint8_t> tile(TILE_BYTES_);
+    std::vector<uint8_t> encoded(TILE_BYTES_ * 2);
+
+    /* collect explored tiles first, the number of tiles is written in front of them */
+    std::vector<std::tuple<uint16_t, std::vector<uint8_t>>> tiles;
+    for (size_t i {}; i < tiles_per_dim * tiles_per_dim; ++i) {
+        const size_t x { (i % tiles_per_dim) * TILE_SIZE_ };
+        const size_t y { (i / tiles_per_dim) * TILE_SIZE_ };
+        bool explored {};
+        for (size_t row {}; row < TILE_SIZE_; ++row) {
+            const auto p_line { image.constScanLine(static_cast<int>(y + row)) + x };
+            std::memcpy(tile.data() + row * TILE_SIZE_, p_line, TILE_SIZE_);
+            explored = explored || std::any_of(p_line, p_line + TILE_SIZE_, [](const uint8_t v) { return v != UNKNOWN_; });
+        }
+        if (!explored) {
+            continue;
+        }
+
+        const auto size { ctbot::MapBlockCodec::encode(tile.data(), TILE_BYTES_, encoded.data(), encoded.size()) };
+        tiles.emplace_back(static_cast<uint16_t>(i), std::vector<uint8_t>(encoded.begin(), encoded.begin() + static_cast<ptrdiff_t>(size)));
+    }
+
+    QSaveFile file { filename };
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream out { &file };
+    out.setByteOrder(QDataStream::LittleEndian);
+    out << MAGIC_ << VERSION_ << static_cast<uint16_t>(TILE_SIZE_) << static_cast<uint16_t>(tiles_per_dim);
+
+    out << static_cast<uint32_t>(tiles.size());
+    for (const auto& [index, data] : tiles) {
+        out << index << static_cast<uint32_t>(data.size());
+        out.writeRawData(reinterpret_cast<const char*>(data.data()), static_cast<int>(data.size()));
+    }
+
+    out << static_cast<int32_t>(bot_pos.x()) << static_cast<int32_t>(bot_pos.y()) << static_cast<uint16_t>(bot_heading);
+
+    uint32_t lines {};
+    uint32_t circles {};
+    for (const auto& group : overlays) {
+        lines += static_cast<uint32_t>(group.lines.size());
+        circles += static_cast<uint32_t>(group.circles.size());
+    }
+    out << lines;
+    for (const auto& group : overlays) {
+        for (const auto& line : group.lines) {
+            out << static_cast<int16_t>(line.x1()) << static_cast<int16_t>(line.y1()) << static_cast<int16_t>(line.x2())
+                << static_cast<int16_t>(line.y2()) << static_cast<uint32_t>(group.color.rgba());
+        }
+    }
+    out << circles;
+    for (const auto& group : overlays) {
+        for (const auto& [center, radius] : group.circles) {
+            out << static_cast<int16_t>(center.x()) << static_cast<int16_t>(center.y()) << static_cast<uint16_t>(radius)
+                << static_cast<uint32_t>(group.color.rgba());
+        }
+    }
+
+    return out.status() == QDataStream::Ok && file.commit();
+}
+
+bool MapSnapshot::load(const QString& filename, const size_t tiles_per_dim, const std::function<void(std::vector<Tile>&&)>& on_tiles, Contents& contents) {
+    QFile file { filename };
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream in { &file };
+    in.setByteOrder(QDataStream::LittleEndian);
+    uint32_t magic;
+    uint16_t version, tile_size, tiles;
+    in >> magic >> version >> tile_size >> tiles;
+    if (in.status() != QDataStream::Ok || magic != MAGIC_ || version != VERSION_ || tile_size != TILE_SIZE_ || tiles != tiles_per_dim) {
+        return false;
+    }
+
+    /* decode and hand over tiles in batches, so they can be shown while the rest of the file is read */
+    uint32_t count;
+    in >> count;
+    std::vector<uint8_t> encoded;
+    std::vector<Tile> batch;
+    for (uint32_t i {}; i < count; ++i) {
+        uint16_t index;
+        uint32_t size;
+        in >> index >> size;
+        if (in.status() != QDataStream::Ok || index >= tiles_per_dim * tiles_per_dim || size > TILE_BYTES_ * 2) {
+            return false;
+        }
+
+        encoded.resize(size);
+        if (in.readRawData(reinterpret_cast<char*>(encoded.data()), static_cast<int>(size)) != static_cast<int>(size)) {
+            return false;
+        }
+
+        auto& tile { batch.emplace_back(Tile { index, std::vector<uint8_t>(TILE_BYTES_) }) };
+        if (!ctbot::MapBlockCodec::decode(encoded.data(), size, tile.data.data(), TILE_BYTES_)) {
+            return false;
+        }
+
+        if (batch.size() == TILE_BATCH_) {
+            on_tiles(std::move(batch));
+            batch = {};
+        }
+    }
+    if (!batch.empty()) {
+        on_tiles(std::move(batch));
+    }
+
+    int32_t bot_x, bot_y;
+    uint16_t bot_heading;
+    in >> bot_x >> bot_y >> bot_heading;
+    contents.bot_pos = QPoint { bot_x, bot_y };
+    contents.bot_heading = bot_heading;
+
+    in >> count;
+    for (uint32_t i {}; i < count && in.status() == QDataStream::Ok; ++i) {
+        int16_t x1, y1, x2, y2;
+        uint32_t rgba;
+        in >> x1 >> y1 >> x2 >> y2 >> rgba;
+        contents.lines.emplace_back(QLine { x1, y1, x2, y2 }, QColor::fromRgba(rgba));
+    }
+
+    in >> count;
+    for (uint32_t i {}; i < count && in.status() == QDataStream::Ok; ++i) {
+        int16_t x, y;
+        uint16_t radius;
+        uint32_t rgba;
+        in >> x >> y >> radius >> rgba;
+        contents.circles.emplace_back(QPoint { x, y }, radius, QColor::fromRgba(rgba));
+    }
+
+    return in.status() == QDataStream::Ok;
+}
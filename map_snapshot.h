@@ -0,0 +1,99 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    map_snapshot.h
+ * @brief   Native file format for maps
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#pragma once
+
+#include <QColor>
+#include <QImage>
+#include <QLine>
+#include <QPoint>
+#include <QString>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <tuple>
+#include <vector>
+
+#include "map_overlays.h"
+
+
+/**
+ * @brief Reading and writing of map snapshots
+ *
+ * A snapshot contains only the explored tiles of the map, each one run-length encoded, followed by the bot pose and all lines and circles.
+ * All values are stored in little endian byte order:
+ * - header: magic "CTMS", uint16 version, uint16 tile size, uint16 tiles per dimension
+ * - uint32 number of tiles, per tile: uint16 index, uint32 size of encoded data, encoded data
+ * - bot pose: int32 x, int32 y, uint16 heading
+ * - uint32 number of lines, per line: int16 x1, y1, x2, y2, uint32 RGBA
+ * - uint32 number of circles, per circle: int16 x, y, uint16 radius, uint32 RGBA
+ *
+ * Both functions are blocking and do not touch any MapImageItem, so they can be used by a worker thread.
+ */
+class MapSnapshot {
+public:
+    static constexpr size_t TILE_SIZE_ { 64 };
+    static constexpr size_t TILE_BYTES_ { TILE_SIZE_ * TILE_SIZE_ };
+    static constexpr uint8_t UNKNOWN_ { 128 }; /**< pixel value of unexplored cells */
+
+    struct Tile {
+        size_t index;
+        std::vector<uint8_t> data; /**< TILE_BYTES_ pixels, row by row */
+    };
+
+    struct Contents {
+        QPoint bot_pos;
+        unsigned bot_heading;
+        std::vector<std::tuple<QLine, QColor>> lines;
+        std::vector<std::tuple<QPoint, size_t, QColor>> circles;
+    };
+
+    /**
+     * @brief Write a snapshot
+     * @param[in] filename: Name of file, replaced atomically
+     * @param[in] image: Map image, Format_Indexed8 with a size of a multiple of TILE_SIZE_
+     * @param[in] bot_pos: Bot position
+     * @param[in] bot_heading: Bot heading
+     * @param[in] overlays: Lines and circles
+     * @return true on success
+     */
+    static bool save(
+        const QString& filename, const QImage& image, const QPoint& bot_pos, const unsigned bot_heading, const MapOverlays::Snapshot& overlays);
+
+    /**
+     * @brief Read a snapshot
+     * @param[in] filename: Name of file
+     * @param[in] tiles_per_dim: Expected number of tiles per dimension
+     * @param[in] on_tiles: Called with every batch of decoded tiles, while the file is read
+     * @param[out] contents: Bot pose, lines and circles
+     * @return true on success, false if the file could not be read or is invalid; tiles passed to on_tiles before remain valid
+     */
+    static bool load(const QString& filename, const size_t tiles_per_dim, const std::function<void(std::vector<Tile>&&)>& on_tiles, Contents& contents);
+
+private:
+    static constexpr uint32_t MAGIC_ { 0x534d'5443 }; /**< "CTMS" */
+    static constexpr uint16_t VERSION_ { 1 };
+    static constexpr size_t TILE_BATCH_ { 32 };
+};
@@ -23,17 +23,30 @@
  */
 
 #include <QQmlApplicationEngine>
-#include <QTcpSocket>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <QQmlProperty>
+
+#include <algorithm>
 
 #include "map_viewer.h"
 #include "map_image.h"
+#include "map_sg_item.h"
 #include "connection_manager.h"
 
 
+static_assert(MapImageItem::MAP_PIXEL_SIZE_ * MapImageItem::MAP_PIXEL_SIZE_ / ctbot::MapBlockCodec::BLOCK_SIZE_ == 4'608);
+static_assert(MapImageItem::MAP_SECTION_SIZE_ * 8 == ctbot::MapBlockCodec::QUARTER_SIZE_);
+
 MapViewer::MapViewer(QQmlApplicationEngine* p_engine, ConnectionManagerV1& command_eval)
-    : p_engine_ { p_engine }, p_socket_ { command_eval.get_socket() }, p_fetch_button_ {}, p_clear_button_ {}, p_save_button_ {}, p_map_ {}, receive_state_ {},
-      last_block_ {} {
+    : p_engine_ { p_engine }, p_connection_ { &command_eval }, p_fetch_button_ {}, p_update_button_ {}, p_clear_button_ {}, p_save_button_ {},
+      p_load_button_ {}, p_map_ {}, block_hashes_(MAP_BLOCKS_, ctbot::MapBlockCodec::empty_hash()), sync_generation_ {}, requested_generation_ {},
+      resync_ {}, stats_ {}, history_ { MAP_BLOCKS_ }, shown_hashes_(MAP_BLOCKS_, ctbot::MapBlockCodec::empty_hash()), playback_ {},
+      last_history_info_ {}, p_viewer_object_ {}, p_scrub_slider_ {}, snapshot_loading_ {} {
+    clock_.start();
+
     qmlRegisterType<MapImageItem>("MapImage", 1, 0, "MapImageItem");
+    qmlRegisterType<MapSGItem>("MapImage", 1, 0, "MapSGItem");
 
     command_eval.register_cmd(ctbot::CommandCodes::CMD_MAP, [this](const ctbot::CommandBase& cmd) {
         // std::cout << "CMD_MAP received: " << cmd << "\n";
@@ -46,58 +59,100 @@ MapViewer::MapViewer(QQmlApplicationEngine* p_engine, ConnectionManagerV1& comma
             }
         }
 
-        const auto block { cmd.get_cmd_data_l() }; // 16 Bit Adresse des Map-Blocks
+        constexpr size_t QUARTER_SIZE { ctbot::MapBlockCodec::QUARTER_SIZE_ };
+        const auto block { static_cast<uint16_t>(cmd.get_cmd_data_l()) }; // 16 Bit Adresse des Map-Blocks
         switch (cmd.get_cmd_subcode()) {
-            case ctbot::CommandCodes::CMD_SUB_MAP_DATA_1: {
-                if (receive_state_ != 0) {
-                    receive_state_ = 0;
+            case ctbot::CommandCodes::CMD_SUB_MAP_DATA_1:
+            case ctbot::CommandCodes::CMD_SUB_MAP_DATA_2:
+            case ctbot::CommandCodes::CMD_SUB_MAP_DATA_3:
+            case ctbot::CommandCodes::CMD_SUB_MAP_DATA_4: {
+                if (cmd.get_payload_size() < QUARTER_SIZE) {
                     return false;
                 }
-                p_map_->set_bot_y(MapImageItem::MAP_PIXEL_SIZE_ - cmd.get_cmd_data_r()); // Bot-Position, X-Komponente, wird im Bild in Y-Richtung gezaehlt
-                p_map_->update_map(cmd.get_payload().data(), block, 0, 7);
-                receive_state_ = 1;
-                last_block_ = block;
+
+                const size_t quarter { static_cast<size_t>(cmd.get_cmd_subcode_uint() - static_cast<uint8_t>(ctbot::CommandCodes::CMD_SUB_MAP_DATA_1)) };
+                switch (quarter) {
+                    case 0:
+                        // Bot-Position, X-Komponente, wird im Bild in Y-Richtung gezaehlt
+                        p_map_->set_bot_y(MapImageItem::MAP_PIXEL_SIZE_ - cmd.get_cmd_data_r());
+                        break;
+
+                    case 1:
+                        // Bot-Position, Y-Komponente, wird im Bild in X-Richtung gezaehlt
+                        p_map_->set_bot_x(MapImageItem::MAP_PIXEL_SIZE_ - cmd.get_cmd_data_r());
+                        break;
+
+                    case 2: p_map_->set_bot_heading(cmd.get_cmd_data_r()); break;
+
+                    default: break;
+                }
+                stats_.bytes += cmd.get_payload_size();
+
+                /* quarters may arrive in any order, the block is applied once complete */
+                const auto p_block { assembler_.add(block, quarter, cmd.get_payload().data(), clock_.elapsed()) };
+                if (p_block) {
+                    apply_block(block, *p_block);
+                    p_map_->commit();
+                    follow_bot();
+                }
                 break;
             }
 
-            case ctbot::CommandCodes::CMD_SUB_MAP_DATA_2: {
-                if (receive_state_ != 1 || last_block_ != block) {
-                    receive_state_ = 0;
+            case ctbot::CommandCodes::CMD_SUB_MAP_DATA_RLE: {
+                ctbot::MapBlockCodec::Block data;
+                if (!ctbot::MapBlockCodec::decode(cmd.get_payload().data(), cmd.get_payload_size(), data)) {
                     return false;
                 }
-                p_map_->set_bot_x(MapImageItem::MAP_PIXEL_SIZE_ - cmd.get_cmd_data_r()); // Bot-Position, Y-Komponente, wird im Bild in X-Richtung gezaehlt
-                p_map_->update_map(cmd.get_payload().data(), block, 8, 15);
-                receive_state_ = 2;
+                stats_.bytes += cmd.get_payload_size();
+                ++stats_.rle_blocks;
+                apply_block(block, data);
+                p_map_->commit();
                 break;
             }
 
-            case ctbot::CommandCodes::CMD_SUB_MAP_DATA_3: {
-                if (receive_state_ != 2 || last_block_ != block) {
-                    receive_state_ = 0;
+            case ctbot::CommandCodes::CMD_SUB_MAP_DATA_SKIP: {
+                const auto count { static_cast<uint16_t>(cmd.get_cmd_data_r()) };
+                if (cmd.get_payload_size() < count * sizeof(uint32_t) || static_cast<size_t>(block) + count > MAP_BLOCKS_) {
                     return false;
                 }
-                p_map_->set_bot_heading(cmd.get_cmd_data_r());
-                p_map_->update_map(cmd.get_payload().data(), block, 16, 23);
-                receive_state_ = 3;
+                stats_.bytes += cmd.get_payload_size();
+
+                /* bot reports blocks unchanged since the requested generation, verify them against the displayed content */
+                const auto p_hash { cmd.get_payload().data() };
+                for (size_t i {}; i < count; ++i) {
+                    const uint32_t hash { p_hash[i * 4] | p_hash[i * 4 + 1] << 8 | p_hash[i * 4 + 2] << 16 | static_cast<uint32_t>(p_hash[i * 4 + 3]) << 24 };
+                    if (hash != block_hashes_[block + i]) {
+                        ++stats_.hash_mismatches;
+                        resync_ = true;
+                    } else {
+                        ++stats_.skipped;
+                    }
+                }
                 break;
             }
 
-            case ctbot::CommandCodes::CMD_SUB_MAP_DATA_4: {
-                static QPoint last_bot_pos {};
-
-                if (receive_state_ != 3 || last_block_ != block) {
-                    receive_state_ = 0;
-                    return false;
+            case ctbot::CommandCodes::CMD_SUB_MAP_DELTA_DONE: {
+                if (cmd.get_payload_size() >= 6) {
+                    const auto& payload { cmd.get_payload() };
+                    const auto x { static_cast<int16_t>(payload[0] | payload[1] << 8) };
+                    const auto y { static_cast<int16_t>(payload[2] | payload[3] << 8) };
+                    const auto heading { static_cast<int16_t>(payload[4] | payload[5] << 8) };
+                    p_map_->set_bot_y(MapImageItem::MAP_PIXEL_SIZE_ - x);
+                    p_map_->set_bot_x(MapImageItem::MAP_PIXEL_SIZE_ - y);
+                    p_map_->set_bot_heading(heading);
+                    p_map_->commit();
+                    follow_bot();
                 }
-                p_map_->update_map(cmd.get_payload().data(), block, 24, 31);
-                p_map_->commit();
-                const auto bot_pos { p_map_->get_bot_pos() };
-                if ((last_bot_pos - bot_pos).manhattanLength() > 10) {
-                    last_bot_pos = bot_pos;
 
-                    QMetaObject::invokeMethod(p_map_, "scroll_to", Q_ARG(QVariant, bot_pos.x()), Q_ARG(QVariant, bot_pos.y()));
+                if (resync_ && requested_generation_) {
+                    /* displayed map differs from the bot's one, fetch all blocks once */
+                    resync_ = false;
+                    sync_generation_ = 0;
+                    request_map(ctbot::CommandCodes::CMD_SUB_MAP_DELTA_REQUEST, 0);
+                } else {
+                    resync_ = false;
+                    sync_generation_ = static_cast<uint16_t>(cmd.get_cmd_data_l()) | static_cast<uint32_t>(static_cast<uint16_t>(cmd.get_cmd_data_r())) << 16;
                 }
-                receive_state_ = 0;
                 break;
             }
 
@@ -168,27 +223,147 @@ MapViewer::MapViewer(QQmlApplicationEngine* p_engine, ConnectionManagerV1& comma
 }
 
 MapViewer::~MapViewer() {
+    delete p_scrub_slider_;
+    delete p_load_button_;
+    delete p_save_button_;
     delete p_clear_button_;
+    delete p_update_button_;
     delete p_fetch_button_;
 }
 
+void MapViewer::apply_block(const uint16_t block, const ctbot::MapBlockCodec::Block& data) {
+    if (block >= MAP_BLOCKS_) {
+        return;
+    }
+
+    ++stats_.blocks;
+    const auto hash { ctbot::MapBlockCodec::hash(data) };
+    if (hash == block_hashes_[block]) {
+        ++stats_.unchanged;
+        return;
+    }
+
+    const auto now { clock_.elapsed() };
+    history_.record(now, block, data);
+    block_hashes_[block] = hash;
+    if (now - last_history_info_ >= 1'000) {
+        update_history_info();
+    }
+
+    if (!playback_) {
+        p_map_->update_map(data.data(), block, 0, MapImageItem::MAP_SECTION_SIZE_ * 2 - 1);
+        shown_hashes_[block] = hash;
+    }
+}
+
+void MapViewer::show_blocks(const std::vector<uint8_t>& blocks) {
+    /* only blocks that differ from the displayed ones are copied and repainted */
+    for (size_t block {}; block < MAP_BLOCKS_; ++block) {
+        const auto p_data { &blocks[block * ctbot::MapBlockCodec::BLOCK_SIZE_] };
+        const auto hash { ctbot::MapBlockCodec::hash(p_data) };
+        if (hash != shown_hashes_[block]) {
+            p_map_->update_map(p_data, block, 0, MapImageItem::MAP_SECTION_SIZE_ * 2 - 1);
+            shown_hashes_[block] = hash;
+        }
+    }
+    p_map_->commit();
+}
+
+void MapViewer::set_history_position(const double position) {
+    if (!p_map_ || history_.get_begin() < 0) {
+        return;
+    }
+
+    if (position >= 1.) {
+        set_live();
+        return;
+    }
+
+    const auto begin { history_.get_begin() };
+    const auto time { begin + static_cast<int64_t>(std::max(position, 0.) * static_cast<double>(history_.get_end() - begin)) };
+    std::vector<uint8_t> blocks;
+    history_.reconstruct(time, blocks);
+    playback_ = true;
+    show_blocks(blocks);
+}
+
+void MapViewer::set_live() {
+    if (!playback_) {
+        return;
+    }
+
+    playback_ = false;
+    show_blocks(history_.get_current());
+}
+
+void MapViewer::update_history_info() {
+    last_history_info_ = clock_.elapsed();
+    if (!p_viewer_object_) {
+        return;
+    }
+
+    const auto begin { history_.get_begin() };
+    const auto duration { begin < 0 ? 0. : static_cast<double>(history_.get_end() - begin) / 1'000. };
+    QQmlProperty::write(p_viewer_object_, "historyDuration", duration);
+    QQmlProperty::write(p_viewer_object_, "historyMemory", static_cast<double>(history_.get_memory_usage()) / 1024. / 1024.);
+    QQmlProperty::write(p_viewer_object_, "historyMemoryPerHour", history_.get_bytes_per_hour() / 1024. / 1024.);
+}
+
+void MapViewer::follow_bot() {
+    const auto bot_pos { p_map_->get_bot_pos() };
+    if ((last_bot_pos_ - bot_pos).manhattanLength() > 10) {
+        last_bot_pos_ = bot_pos;
+
+        QMetaObject::invokeMethod(p_map_, "scroll_to", Q_ARG(QVariant, bot_pos.x()), Q_ARG(QVariant, bot_pos.y()));
+    }
+}
+
+void MapViewer::request_map(const ctbot::CommandCodes& subcmd, const uint32_t generation) {
+    ctbot::CommandNoCRC cmd { ctbot::CommandCodes::CMD_MAP, subcmd, static_cast<int16_t>(generation & 0xffff), static_cast<int16_t>(generation >> 16),
+        ctbot::CommandBase::ADDR_SIM, ctbot::CommandBase::ADDR_BROADCAST };
+    if (p_connection_->is_open()) {
+        requested_generation_ = generation;
+        p_connection_->send(cmd);
+    }
+}
+
+void MapViewer::reset_sync() {
+    std::fill(block_hashes_.begin(), block_hashes_.end(), ctbot::MapBlockCodec::empty_hash());
+    std::fill(shown_hashes_.begin(), shown_hashes_.end(), ctbot::MapBlockCodec::empty_hash());
+    history_.clear();
+    playback_ = false;
+    update_history_info();
+    sync_generation_ = 0;
+    resync_ = false;
+    assembler_.clear();
+}
+
+void MapViewer::rehash_blocks() {
+    ctbot::MapBlockCodec::Block data;
+    for (size_t block {}; block < MAP_BLOCKS_; ++block) {
+        if (p_map_->read_block(block, data.data())) {
+            block_hashes_[block] = ctbot::MapBlockCodec::hash(data);
+            shown_hashes_[block] = block_hashes_[block];
+        }
+    }
+}
+
 void MapViewer::register_buttons() {
     auto root { p_engine_->rootObjects() };
     p_map_ = root.first()->findChild<MapImageItem*>("Map");
-    if (!p_map_) {
+    p_viewer_object_ = root.first()->findChild<QObject*>("MapViewer");
+    if (!p_map_ || !p_viewer_object_) {
         return;
     }
 
-    p_fetch_button_ = new ConnectButton { [this](QString, QString) {
-        ctbot::CommandNoCRC cmd { ctbot::CommandCodes::CMD_MAP, ctbot::CommandCodes::CMD_SUB_MAP_REQUEST, 0, 0, ctbot::CommandBase::ADDR_SIM,
-            ctbot::CommandBase::ADDR_BROADCAST };
-        if (p_socket_->isOpen()) {
-            p_socket_->write(reinterpret_cast<const char*>(&cmd.get_cmd()), sizeof(ctbot::CommandData));
-        }
-    } };
+    p_fetch_button_ = new ConnectButton { [this](QString, QString) { request_map(ctbot::CommandCodes::CMD_SUB_MAP_REQUEST, 0); } };
     QObject::connect(root.first()->findChild<QObject*>("MapViewer"), SIGNAL(mapFetch()), p_fetch_button_, SLOT(cppSlot()));
 
+    p_update_button_ = new ConnectButton { [this](QString, QString) { request_map(ctbot::CommandCodes::CMD_SUB_MAP_DELTA_REQUEST, sync_generation_); } };
+    QObject::connect(root.first()->findChild<QObject*>("MapViewer"), SIGNAL(mapUpdate()), p_update_button_, SLOT(cppSlot()));
+
     p_clear_button_ = new ConnectButton { [this](QString, QString) {
+        reset_sync();
         p_map_->clear();
         p_map_->set_bot_x(0);
         p_map_->set_bot_y(0);
@@ -197,6 +372,37 @@ void MapViewer::register_buttons() {
     } };
     QObject::connect(root.first()->findChild<QObject*>("MapViewer"), SIGNAL(mapClear()), p_clear_button_, SLOT(cppSlot()));
 
-    p_save_button_ = new ConnectButton { [this](QString filename, QString) { p_map_->save_to_file(filename); } };
+    p_save_button_ = new ConnectButton { [this](QString filename, QString) {
+        if (filename.endsWith(QStringLiteral(".ctmap"))) {
+            p_map_->save_snapshot(filename);
+        } else {
+            QElapsedTimer timer;
+            timer.start();
+            if (p_map_->save_to_file(filename)) {
+                qDebug() << "MapViewer: PNG saved in" << timer.elapsed() << "ms";
+            }
+        }
+    } };
     QObject::connect(root.first()->findChild<QObject*>("MapViewer"), SIGNAL(mapSave(QString)), p_save_button_, SLOT(cppSlot(QString)));
+
+    p_load_button_ = new ConnectButton { [this](QString filename, QString) {
+        if (p_map_->load_snapshot(filename)) {
+            /* block hashes are recalculated from the displayed map once the snapshot is loaded */
+            reset_sync();
+            snapshot_loading_ = true;
+        }
+    } };
+    QObject::connect(root.first()->findChild<QObject*>("MapViewer"), SIGNAL(mapLoad(QString)), p_load_button_, SLOT(cppSlot(QString)));
+
+    p_scrub_slider_ = new ConnectButton { [this](QString position, QString) { set_history_position(position.toDouble()); } };
+    QObject::connect(root.first()->findChild<QObject*>("MapViewer"), SIGNAL(mapScrub(QString)), p_scrub_slider_, SLOT(cppSlot(QString)));
+
+    QObject::connect(p_map_, &MapImageItem::snapshotFinished, p_load_button_, [this](bool success, int milliseconds) {
+        qDebug() << "MapViewer: map snapshot" << (success ? "done" : "failed") << "after" << milliseconds << "ms";
+        if (snapshot_loading_) {
+            /* all tiles were applied before, a failed load left an empty map */
+            snapshot_loading_ = false;
+            rehash_blocks();
+        }
+    });
 }
@@ -24,25 +24,68 @@
 
 #pragma once
 
+#include <QElapsedTimer>
+#include <QPoint>
+
 #include <cstdint>
+#include <vector>
 
+#include "command.h"
 #include "connect_button.h"
+#include "map_block_assembler.h"
+#include "map_block_codec.h"
+#include "map_history.h"
 
 
 class QQmlApplicationEngine;
-class QTcpSocket;
 class ConnectionManagerV1;
 class MapImageItem;
 
 class MapViewer {
+public:
+    struct SyncStatistics {
+        uint64_t blocks; /**< number of complete blocks received */
+        uint64_t unchanged; /**< number of received blocks equal to the displayed content */
+        uint64_t rle_blocks; /**< number of blocks received run-length encoded */
+        uint64_t skipped; /**< number of blocks reported unchanged by the bot */
+        uint64_t hash_mismatches; /**< number of unchanged blocks reported by the bot that differ from the displayed content */
+        uint64_t bytes; /**< payload bytes of map data received */
+    };
+
+private:
+    static constexpr size_t MAP_BLOCKS_ { 4'608 };
+
     QQmlApplicationEngine* p_engine_;
-    QTcpSocket* p_socket_;
+    ConnectionManagerV1* p_connection_;
     ConnectButton* p_fetch_button_;
+    ConnectButton* p_update_button_;
     ConnectButton* p_clear_button_;
     ConnectButton* p_save_button_;
+    ConnectButton* p_load_button_;
     MapImageItem* p_map_;
-    unsigned receive_state_;
-    uint16_t last_block_;
+    MapBlockAssembler assembler_;
+    QElapsedTimer clock_;
+    std::vector<uint32_t> block_hashes_; /**< hash of displayed content per block */
+    uint32_t sync_generation_; /**< map generation of the bot the displayed map is synchronized to */
+    uint32_t requested_generation_;
+    bool resync_;
+    QPoint last_bot_pos_;
+    SyncStatistics stats_;
+    MapHistory history_;
+    std::vector<uint32_t> shown_hashes_; /**< hash of displayed content per block, differs from block_hashes_ during playback */
+    bool playback_;
+    int64_t last_history_info_;
+    QObject* p_viewer_object_;
+    ConnectButton* p_scrub_slider_;
+    bool snapshot_loading_; /**< a map snapshot is being loaded, block hashes are recalculated when done */
+
+    void apply_block(const uint16_t block, const ctbot::MapBlockCodec::Block& data);
+    void follow_bot();
+    void request_map(const ctbot::CommandCodes& subcmd, const uint32_t generation);
+    void reset_sync();
+    void rehash_blocks();
+    void show_blocks(const std::vector<uint8_t>& blocks);
+    void update_history_info();
 
 public:
     MapViewer(QQmlApplicationEngine* p_engine, ConnectionManagerV1& command_eval);
@@ -50,4 +93,38 @@ public:
     ~MapViewer();
 
     void register_buttons();
+
+    const auto& get_statistics() const {
+        return stats_;
+    }
+
+    /**
+     * @return Statistics of the reassembly of CMD_SUB_MAP_DATA_1..4, i.e. completed, out of order, duplicate and dropped quarters or blocks
+     */
+    const auto& get_assembly_statistics() const {
+        return assembler_.get_statistics();
+    }
+
+    size_t get_partial_blocks() const {
+        return assembler_.get_partial_count();
+    }
+
+    /**
+     * @brief Show the map at an earlier time, new map data is recorded but not shown until set_live() is called
+     * @param[in] position: Position in recorded history, 0 for oldest state, 1 for newest one
+     */
+    void set_history_position(const double position);
+
+    /**
+     * @brief Leave playback and show current map
+     */
+    void set_live();
+
+    bool is_playback() const {
+        return playback_;
+    }
+
+    const auto& get_history() const {
+        return history_;
+    }
 };
@@ -0,0 +1,86 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    receive_buffer.cpp
+ * @brief   Fixed-capacity receive buffer for incoming byte streams
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "receive_buffer.h"
+
+
+ReceiveBuffer::ReceiveBuffer(const size_t capacity) : p_data_ { new char[capacity] }, capacity_ { capacity }, read_pos_ {}, write_pos_ {} {}
+
+void ReceiveBuffer::compact() {
+    const auto n { size() };
+    if (n) {
+        std::memmove(p_data_.get(), data(), n);
+    }
+    read_pos_ = 0;
+    write_pos_ = n;
+}
+
+char* ReceiveBuffer::prepare() {
+    if (read_pos_ && writable() < capacity_ / 2) {
+        compact();
+    }
+
+    return p_data_.get() + write_pos_;
+}
+
+void ReceiveBuffer::commit(const size_t n) {
+    write_pos_ += std::min(n, writable());
+}
+
+size_t ReceiveBuffer::append(const char* data, const size_t len) {
+    if (writable() < len) {
+        compact();
+    }
+
+    const auto n { std::min(len, writable()) };
+    std::memcpy(p_data_.get() + write_pos_, data, n);
+    write_pos_ += n;
+
+    return n;
+}
+
+void ReceiveBuffer::consume(const size_t n) {
+    read_pos_ += std::min(n, size());
+
+    if (read_pos_ == write_pos_) {
+        clear();
+    }
+}
+
+size_t ReceiveBuffer::find(const char c, const size_t from) const {
+    if (from >= size()) {
+        return npos;
+    }
+
+    const auto ptr { static_cast<const char*>(std::memchr(data() + from, c, size() - from)) };
+
+    return ptr ? static_cast<size_t>(ptr - data()) : npos;
+}
+
+size_t ReceiveBuffer::find(const std::string_view& str, const size_t from) const {
+    return view().find(str, from);
+}
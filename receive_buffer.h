@@ -0,0 +1,100 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    receive_buffer.h
+ * @brief   Fixed-capacity receive buffer for incoming byte streams
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+
+/**
+ * @brief Fixed-capacity byte buffer with separate read and write cursors
+ *
+ * Consumed data is skipped by advancing the read cursor, so parsing a frame never shifts the buffer. The unread rest is moved to the front only when
+ * the free space behind the write cursor runs low, which happens at most once per filled buffer. All unread data is always contiguous and can be
+ * parsed through views returned by view().
+ */
+class ReceiveBuffer {
+    std::unique_ptr<char[]> p_data_;
+    const size_t capacity_;
+    size_t read_pos_;
+    size_t write_pos_;
+
+    void compact();
+
+public:
+    static constexpr size_t npos { std::string_view::npos };
+
+    explicit ReceiveBuffer(const size_t capacity);
+
+    size_t size() const {
+        return write_pos_ - read_pos_;
+    }
+
+    bool empty() const {
+        return read_pos_ == write_pos_;
+    }
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    size_t free_space() const {
+        return capacity_ - size();
+    }
+
+    const char* data() const {
+        return p_data_.get() + read_pos_;
+    }
+
+    std::string_view view() const {
+        return std::string_view { data(), size() };
+    }
+
+    /**
+     * @brief Get write position for direct writes (e.g. socket reads)
+     * @return Pointer to contiguous free space of writable() bytes, has to be followed by commit()
+     */
+    char* prepare();
+
+    size_t writable() const {
+        return capacity_ - write_pos_;
+    }
+
+    void commit(const size_t n);
+
+    size_t append(const char* data, const size_t len);
+
+    void consume(const size_t n);
+
+    size_t find(const char c, const size_t from = 0) const;
+
+    size_t find(const std::string_view& str, const size_t from = 0) const;
+
+    void clear() {
+        read_pos_ = 0;
+        write_pos_ = 0;
+    }
+};
@@ -25,7 +25,6 @@
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
 #include <QQuickItem>
-#include <QTcpSocket>
 #include <QDebug>
 
 #include "remotecall_viewer.h"
@@ -33,7 +32,7 @@
 
 
 RemotecallViewer::RemotecallViewer(QQmlApplicationEngine* p_engine, ConnectionManagerV1& command_eval)
-    : p_rcList_ { new RCList }, p_engine_ { p_engine }, p_socket_ { command_eval.get_socket() }, p_rc_viewer_ {}, p_current_label_ {}, p_fetch_button_ {},
+    : p_rcList_ { new RCList }, p_engine_ { p_engine }, p_connection_ { &command_eval }, p_rc_viewer_ {}, p_current_label_ {}, p_fetch_button_ {},
       p_clear_button_ {}, p_abort_button_ {}, p_rc_button_ {} {
     qmlRegisterType<RCModel>("RemoteCalls", 1, 0, "RemotecallModel");
     qmlRegisterUncreatableType<RCList>("RemoteCalls", 1, 0, "RCList", QStringLiteral("RemoteCalls should not be created in QML"));
@@ -106,8 +105,8 @@ void RemotecallViewer::register_buttons() {
     p_fetch_button_ = new ConnectButton { [this](QString, QString) {
         ctbot::CommandNoCRC cmd { ctbot::CommandCodes::CMD_REMOTE_CALL, ctbot::CommandCodes::CMD_SUB_REMOTE_CALL_LIST, 0, 0, ctbot::CommandBase::ADDR_SIM,
             ctbot::CommandBase::ADDR_BROADCAST };
-        if (p_socket_->isOpen()) {
-            p_socket_->write(reinterpret_cast<const char*>(&cmd.get_cmd()), sizeof(ctbot::CommandData));
+        if (p_connection_->is_open()) {
+            p_connection_->send(cmd);
         }
     } };
     auto root { p_engine_->rootObjects() };
@@ -128,8 +127,8 @@ void RemotecallViewer::register_buttons() {
     p_abort_button_ = new ConnectButton { [this](QString, QString) {
         ctbot::CommandNoCRC cmd { ctbot::CommandCodes::CMD_REMOTE_CALL, ctbot::CommandCodes::CMD_SUB_REMOTE_CALL_ABORT, 0, 0, ctbot::CommandBase::ADDR_SIM,
             ctbot::CommandBase::ADDR_BROADCAST };
-        if (p_socket_->isOpen()) {
-            p_socket_->write(reinterpret_cast<const char*>(&cmd.get_cmd()), sizeof(ctbot::CommandData));
+        if (p_connection_->is_open()) {
+            p_connection_->send(cmd);
         }
 
         p_rc_viewer_->setProperty("enabled", true);
@@ -163,11 +162,8 @@ void RemotecallViewer::register_buttons() {
 
         cmd.add_payload(payload.data(), static_cast<size_t>(payload.size()));
 
-        if (p_socket_->isOpen()) {
-            qint64 sent { p_socket_->write(reinterpret_cast<const char*>(&cmd.get_cmd()), sizeof(ctbot::CommandData)) };
-            if (cmd.get_payload_size()) {
-                sent += p_socket_->write(reinterpret_cast<const char*>(cmd.get_payload().data()), static_cast<int64_t>(cmd.get_payload_size()));
-            }
+        if (p_connection_->is_open()) {
+            const auto sent { p_connection_->send(cmd) };
             qDebug() << "sent" << sent << "bytes.";
         }
 
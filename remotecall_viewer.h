@@ -33,7 +33,6 @@
 
 
 class QQmlApplicationEngine;
-class QTcpSocket;
 class QQuickItem;
 class ConnectionManagerV1;
 
@@ -41,7 +40,7 @@ class RemotecallViewer {
     RCList* p_rcList_;
     RCModel rc_model_;
     QQmlApplicationEngine* p_engine_;
-    QTcpSocket* p_socket_;
+    ConnectionManagerV1* p_connection_;
     QObject* p_rc_viewer_;
     QObject* p_current_label_;
     ConnectButton* p_fetch_button_;
@@ -23,7 +23,6 @@
  */
 
 #include <QQmlApplicationEngine>
-#include <QTcpSocket>
 
 #include "remotecontrol_viewer.h"
 #include "connection_manager.h"
@@ -60,12 +59,8 @@ void RemoteControlViewerV1::register_buttons() {
         ctbot::CommandNoCRC cmd { ctbot::CommandCodes::CMD_SENS_RC5, ctbot::CommandCodes::CMD_SUB_NORM, rc5code, 0, ctbot::CommandBase::ADDR_SIM,
             ctbot::CommandBase::ADDR_BROADCAST };
 
-        if (conn_manager_.get_socket()->isOpen()) {
-            qint64 sent { conn_manager_.get_socket()->write(reinterpret_cast<const char*>(&cmd.get_cmd()), sizeof(ctbot::CommandData)) };
-            if (cmd.get_payload_size()) {
-                sent +=
-                    conn_manager_.get_socket()->write(reinterpret_cast<const char*>(cmd.get_payload().data()), static_cast<int64_t>(cmd.get_payload_size()));
-            }
+        if (conn_manager_.is_open()) {
+            const auto sent { conn_manager_.send(cmd) };
             // qDebug() << "RemoteControlViewerV1: sent" << sent << "bytes.";
             static_cast<void>(sent);
         }
@@ -102,8 +97,8 @@ void RemoteControlViewerV2::register_buttons() {
 
         QString data { "s rc5 6 " + QString::number(rc5code) + "\r\n" };
 
-        if (conn_manager_.get_socket()->isOpen()) {
-            conn_manager_.get_socket()->write(data.toUtf8(), data.length());
+        if (conn_manager_.is_open()) {
+            conn_manager_.write(data.toUtf8());
         }
     } };
     auto root { p_engine_->rootObjects() };
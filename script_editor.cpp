@@ -24,17 +24,22 @@
 
 #include <QQmlApplicationEngine>
 #include <QQuickItem>
-#include <QTcpSocket>
-#include <QThread>
 #include <QFile>
+#include <QTextStream>
+#include <QDebug>
+
+#include <algorithm>
 
 #include "script_editor.h"
 #include "command.h"
+#include "connection_manager.h"
 
 
-ScriptEditor::ScriptEditor(QQmlApplicationEngine* p_engine, QTcpSocket* p_socket)
-    : p_engine_ { p_engine }, p_socket_ { p_socket }, p_script_ {}, p_editor_ {}, p_type_ {}, p_execute_ {}, p_filename_ {}, p_load_button_ {},
-      p_save_button_ {}, p_send_button_ {}, p_abort_button_ {} {}
+ScriptEditor::ScriptEditor(QQmlApplicationEngine* p_engine, ConnectionManagerV1& command_eval)
+    : p_engine_ { p_engine }, p_connection_ { &command_eval }, p_script_ {}, p_editor_ {}, p_type_ {}, p_execute_ {}, p_filename_ {}, p_load_button_ {},
+      p_save_button_ {}, p_send_button_ {}, p_abort_button_ {}, upload_ {} {
+    QObject::connect(&upload_timer_, &QTimer::timeout, p_engine_, [this]() { upload_next(); });
+}
 
 ScriptEditor::~ScriptEditor() {
     delete p_abort_button_;
@@ -99,7 +104,7 @@ void ScriptEditor::register_buttons() {
     QObject::connect(p_script_, SIGNAL(scriptSave(QString)), p_save_button_, SLOT(cppSlot(QString)));
 
     p_send_button_ = new ConnectButton { [this](QString, QString) {
-        if (!p_socket_->isOpen()) {
+        if (!p_connection_->is_open() || upload_timer_.isActive()) {
             return;
         }
 
@@ -119,65 +124,84 @@ void ScriptEditor::register_buttons() {
         ctbot::CommandNoCRC cmd { ctbot::CommandCodes::CMD_PROGRAM, ctbot::CommandCodes::CMD_SUB_PROGRAM_PREPARE, static_cast<int16_t>(type), content_length,
             ctbot::CommandBase::ADDR_SIM, ctbot::CommandBase::ADDR_BROADCAST };
         cmd.add_payload(remote_filename.constData(), remote_filename.length());
+        p_connection_->send(cmd);
 
-        qint64 sent { p_socket_->write(reinterpret_cast<const char*>(&cmd.get_cmd()), sizeof(ctbot::CommandData)) };
-        sent += p_socket_->write(reinterpret_cast<const char*>(cmd.get_payload().data()), static_cast<int64_t>(cmd.get_payload_size()));
-        p_socket_->flush();
-
-        // qDebug() << "script prepared, sent=" << sent;
-        QThread::usleep(75 * 3'000); // FIXME: use timer?
-
-        sent = 0;
-        int16_t i {};
-        for (; i < content_length / 64; ++i) {
-            ctbot::CommandNoCRC cmd { ctbot::CommandCodes::CMD_PROGRAM, ctbot::CommandCodes::CMD_SUB_PROGRAM_DATA, static_cast<int16_t>(type),
-                static_cast<int16_t>(i * 64), ctbot::CommandBase::ADDR_SIM, ctbot::CommandBase::ADDR_BROADCAST };
-            cmd.add_payload(&content_array.constData()[i * 64], 64);
-            sent += p_socket_->write(reinterpret_cast<const char*>(&cmd.get_cmd()), sizeof(ctbot::CommandData));
-            sent += p_socket_->write(reinterpret_cast<const char*>(cmd.get_payload().data()), static_cast<int64_t>(cmd.get_payload_size()));
-            p_socket_->flush();
-
-            QThread::usleep(75 * 1'000); // FIXME: use timer?
-        }
-
-        const auto to_send { content_length % 64 };
-        // qDebug() << "to_send=" << to_send;
-
-        if (to_send) {
-            ctbot::CommandNoCRC cmd { ctbot::CommandCodes::CMD_PROGRAM, ctbot::CommandCodes::CMD_SUB_PROGRAM_DATA, static_cast<int16_t>(type),
-                static_cast<int16_t>(i * 64), ctbot::CommandBase::ADDR_SIM, ctbot::CommandBase::ADDR_BROADCAST };
-            cmd.add_payload(&content_array.constData()[i * 64], to_send);
-            sent += p_socket_->write(reinterpret_cast<const char*>(&cmd.get_cmd()), sizeof(ctbot::CommandData));
-            sent += p_socket_->write(reinterpret_cast<const char*>(cmd.get_payload().data()), static_cast<int64_t>(cmd.get_payload_size()));
-            p_socket_->flush();
-
-            QThread::usleep(75 * 1'000); // FIXME: use timer?
-        }
-
-        qDebug() << "script sent," << sent << "bytes.";
-
-        if (execute) {
-            ctbot::CommandNoCRC cmd { ctbot::CommandCodes::CMD_PROGRAM, ctbot::CommandCodes::CMD_SUB_PROGRAM_START, static_cast<int16_t>(type), 0,
-                ctbot::CommandBase::ADDR_SIM, ctbot::CommandBase::ADDR_BROADCAST };
-            p_socket_->write(reinterpret_cast<const char*>(&cmd.get_cmd()), sizeof(ctbot::CommandData));
-
-            qDebug() << "script started.";
-        }
+        /* the chunks are sent by upload_next(), after the bot had time to prepare */
+        upload_ = Upload { content_array, type, execute, 0, std::max(1, p_script_->property("uploadWindow").toInt()) };
+        set_progress(0.);
+        p_script_->setProperty("uploading", true);
+        upload_timer_.start(PREPARE_DELAY_MS_);
     } };
     QObject::connect(p_script_, SIGNAL(scriptSend()), p_send_button_, SLOT(cppSlot()));
 
     p_abort_button_ = new ConnectButton { [this](QString, QString) {
-        if (!p_socket_->isOpen()) {
+        if (!p_connection_->is_open()) {
             return;
         }
 
+        if (upload_timer_.isActive()) {
+            finish_upload(false);
+        }
+
         const bool type { p_type_->property("checked").toBool() }; // false: basic, true: abl
 
         ctbot::CommandNoCRC cmd { ctbot::CommandCodes::CMD_PROGRAM, ctbot::CommandCodes::CMD_SUB_PROGRAM_STOP, static_cast<int16_t>(type), 0,
             ctbot::CommandBase::ADDR_SIM, ctbot::CommandBase::ADDR_BROADCAST };
-        p_socket_->write(reinterpret_cast<const char*>(&cmd.get_cmd()), sizeof(ctbot::CommandData));
+        p_connection_->send(cmd);
 
         qDebug() << "script aborted.";
     } };
     QObject::connect(p_script_, SIGNAL(scriptAbort()), p_abort_button_, SLOT(cppSlot()));
 }
+
+void ScriptEditor::upload_next() {
+    if (!p_connection_->is_open()) {
+        qDebug() << "script upload failed, connection closed.";
+        finish_upload(false);
+        return;
+    }
+
+    const auto size { upload_.content.size() };
+    if (upload_.offset >= size) {
+        /* the last chunk had its time to be processed */
+        finish_upload(true);
+        return;
+    }
+
+    /* all chunks of one tick are sent together */
+    upload_timer_.setInterval(CHUNK_INTERVAL_MS_);
+    for (int i {}; i < upload_.window && upload_.offset < size; ++i) {
+        const auto len { std::min<qsizetype>(CHUNK_SIZE_, size - upload_.offset) };
+        ctbot::CommandNoCRC cmd { ctbot::CommandCodes::CMD_PROGRAM, ctbot::CommandCodes::CMD_SUB_PROGRAM_DATA, static_cast<int16_t>(upload_.type),
+            static_cast<int16_t>(upload_.offset), ctbot::CommandBase::ADDR_SIM, ctbot::CommandBase::ADDR_BROADCAST };
+        cmd.add_payload(upload_.content.constData() + upload_.offset, static_cast<size_t>(len));
+        p_connection_->send(cmd);
+        upload_.offset += len;
+    }
+
+    set_progress(static_cast<double>(upload_.offset) / static_cast<double>(size));
+}
+
+void ScriptEditor::finish_upload(const bool success) {
+    upload_timer_.stop();
+    p_script_->setProperty("uploading", false);
+
+    if (!success) {
+        return;
+    }
+
+    set_progress(1.);
+    qDebug() << "script sent," << upload_.content.size() << "bytes.";
+
+    if (upload_.execute) {
+        ctbot::CommandNoCRC cmd { ctbot::CommandCodes::CMD_PROGRAM, ctbot::CommandCodes::CMD_SUB_PROGRAM_START, static_cast<int16_t>(upload_.type), 0,
+            ctbot::CommandBase::ADDR_SIM, ctbot::CommandBase::ADDR_BROADCAST };
+        p_connection_->send(cmd);
+
+        qDebug() << "script started.";
+    }
+}
+
+void ScriptEditor::set_progress(const double progress) {
+    p_script_->setProperty("uploadProgress", progress);
+}
@@ -24,15 +24,37 @@
 
 #pragma once
 
+#include <QByteArray>
+#include <QTimer>
+
 #include "connect_button.h"
 
 
 class QQmlApplicationEngine;
-class QTcpSocket;
+class ConnectionManagerV1;
 
+/**
+ * @brief Loading, saving and uploading of scripts
+ *
+ * A script is uploaded without blocking the GUI: after CMD_SUB_PROGRAM_PREPARE the bot gets PREPARE_DELAY_MS_ to open the file, then a timer
+ * sends a window of CHUNK_SIZE_ byte chunks every CHUNK_INTERVAL_MS_. The bot does not acknowledge chunks, so the window (QML property
+ * uploadWindow) trades throughput against the risk of overrunning a slow bot. Progress is shown by the QML property uploadProgress.
+ */
 class ScriptEditor {
+    static constexpr int PREPARE_DELAY_MS_ { 225 };
+    static constexpr int CHUNK_INTERVAL_MS_ { 75 };
+    static constexpr qsizetype CHUNK_SIZE_ { 64 };
+
+    struct Upload {
+        QByteArray content;
+        bool type; /**< false: basic, true: abl */
+        bool execute;
+        qsizetype offset; /**< next byte to send */
+        int window; /**< number of chunks per interval */
+    };
+
     QQmlApplicationEngine* p_engine_;
-    QTcpSocket* p_socket_;
+    ConnectionManagerV1* p_connection_;
     QObject* p_script_;
     QObject* p_editor_;
     QObject* p_type_;
@@ -44,8 +66,15 @@ class ScriptEditor {
     ConnectButton* p_send_button_;
     ConnectButton* p_abort_button_;
 
+    Upload upload_;
+    QTimer upload_timer_;
+
+    void upload_next();
+    void finish_upload(const bool success);
+    void set_progress(const double progress);
+
 public:
-    ScriptEditor(QQmlApplicationEngine* p_engine, QTcpSocket* p_socket);
+    ScriptEditor(QQmlApplicationEngine* p_engine, ConnectionManagerV1& command_eval);
 
     ~ScriptEditor();
 
@@ -34,184 +34,134 @@
 #include "command.h"
 
 
-SensorViewerV1::SensorViewerV1(QQmlApplicationEngine* p_engine, ConnectionManagerV1& command_eval) : ValueViewer { p_engine } {
+SensorViewerV1::SensorViewerV1(QQmlApplicationEngine* p_engine, ConnectionManagerV1& command_eval) : ValueViewer { p_engine, command_eval } {
     qmlRegisterType<ValueModel>("Sensors", 1, 0, "SensorModel");
     qmlRegisterUncreatableType<ValueList>("Sensors", 1, 0, "ValueList", QStringLiteral("Sensors should not be created in QML"));
 
-    list_.appendItem(SPEED_ENC_L_.cbegin());
-    list_.appendItem(SPEED_ENC_R_.cbegin());
-    list_.appendItem(DISTANCE_L_.cbegin());
-    list_.appendItem(DISTANCE_R_.cbegin());
-    list_.appendItem(LINE_L_.cbegin());
-    list_.appendItem(LINE_R_.cbegin());
-    list_.appendItem(BORDER_L_.cbegin());
-    list_.appendItem(BORDER_R_.cbegin());
-    list_.appendItem(LIGHT_L_.cbegin());
-    list_.appendItem(LIGHT_R_.cbegin());
-    list_.appendItem(MOUSE_DX_.cbegin());
-    list_.appendItem(MOUSE_DY_.cbegin());
-    list_.appendItem(DOOR_.cbegin());
-    list_.appendItem(TRANSPORT_.cbegin());
-    list_.appendItem(RC5_.cbegin());
-    list_.appendItem(BPS_.cbegin());
-    list_.appendItem(ERROR_.cbegin());
-
-    update_map();
+    append_slots(SLOT_NAMES_);
     register_model(QStringLiteral("sensorModel"));
 
-    command_eval.register_cmd(ctbot::CommandCodes::CMD_SENS_IR, [this](const ctbot::CommandBase& cmd) {
-        // std::cout << "CMD_SENS_IR received: " << cmd << "\n";
-        model_.setData(map_[DISTANCE_L_.cbegin()], cmd.get_cmd_data_l(), ValueModel::Value);
-        model_.setData(map_[DISTANCE_R_.cbegin()], cmd.get_cmd_data_r(), ValueModel::Value);
+    /* sensor commands are decoded by the I/O thread, values reach the model through telemetry_ */
+    command_eval.register_decoder(ctbot::CommandCodes::CMD_SENS_IR, [this](const ctbot::CommandView& cmd, const int64_t timestamp) {
+        push_sample(SLOT_DISTANCE_L, cmd.header.data_l, timestamp);
+        push_sample(SLOT_DISTANCE_R, cmd.header.data_r, timestamp);
         return true;
     });
 
-    command_eval.register_cmd(ctbot::CommandCodes::CMD_SENS_ENC, [this](const ctbot::CommandBase& cmd) {
-        // std::cout << "CMD_SENS_ENC received: " << cmd << "\n";
-        model_.setData(map_[SPEED_ENC_L_.cbegin()], cmd.get_cmd_data_l(), ValueModel::Value);
-        model_.setData(map_[SPEED_ENC_R_.cbegin()], cmd.get_cmd_data_r(), ValueModel::Value);
+    command_eval.register_decoder(ctbot::CommandCodes::CMD_SENS_ENC, [this](const ctbot::CommandView& cmd, const int64_t timestamp) {
+        push_sample(SLOT_SPEED_ENC_L, cmd.header.data_l, timestamp);
+        push_sample(SLOT_SPEED_ENC_R, cmd.header.data_r, timestamp);
         return true;
     });
 
-    command_eval.register_cmd(ctbot::CommandCodes::CMD_SENS_BORDER, [this](const ctbot::CommandBase& cmd) {
-        // std::cout << "CMD_SENS_BORDER received: " << cmd << "\n";
-        model_.setData(map_[BORDER_L_.cbegin()], cmd.get_cmd_data_l(), ValueModel::Value);
-        model_.setData(map_[BORDER_R_.cbegin()], cmd.get_cmd_data_r(), ValueModel::Value);
+    command_eval.register_decoder(ctbot::CommandCodes::CMD_SENS_BORDER, [this](const ctbot::CommandView& cmd, const int64_t timestamp) {
+        push_sample(SLOT_BORDER_L, cmd.header.data_l, timestamp);
+        push_sample(SLOT_BORDER_R, cmd.header.data_r, timestamp);
         return true;
     });
 
-    command_eval.register_cmd(ctbot::CommandCodes::CMD_SENS_LINE, [this](const ctbot::CommandBase& cmd) {
-        // std::cout << "CMD_SENS_LINE received: " << cmd << "\n";
-        model_.setData(map_[LINE_L_.cbegin()], cmd.get_cmd_data_l(), ValueModel::Value);
-        model_.setData(map_[LINE_R_.cbegin()], cmd.get_cmd_data_r(), ValueModel::Value);
+    command_eval.register_decoder(ctbot::CommandCodes::CMD_SENS_LINE, [this](const ctbot::CommandView& cmd, const int64_t timestamp) {
+        push_sample(SLOT_LINE_L, cmd.header.data_l, timestamp);
+        push_sample(SLOT_LINE_R, cmd.header.data_r, timestamp);
         return true;
     });
 
-    command_eval.register_cmd(ctbot::CommandCodes::CMD_SENS_LDR, [this](const ctbot::CommandBase& cmd) {
-        // std::cout << "CMD_SENS_LDR received: " << cmd << "\n";
-        model_.setData(map_[LIGHT_L_.cbegin()], cmd.get_cmd_data_l(), ValueModel::Value);
-        model_.setData(map_[LIGHT_R_.cbegin()], cmd.get_cmd_data_r(), ValueModel::Value);
+    command_eval.register_decoder(ctbot::CommandCodes::CMD_SENS_LDR, [this](const ctbot::CommandView& cmd, const int64_t timestamp) {
+        push_sample(SLOT_LIGHT_L, cmd.header.data_l, timestamp);
+        push_sample(SLOT_LIGHT_R, cmd.header.data_r, timestamp);
         return true;
     });
 
-    command_eval.register_cmd(ctbot::CommandCodes::CMD_SENS_TRANS, [this](const ctbot::CommandBase& cmd) {
-        // std::cout << "CMD_SENS_TRANS received: " << cmd << "\n";
-        model_.setData(map_[TRANSPORT_.cbegin()], cmd.get_cmd_data_l(), ValueModel::Value);
+    command_eval.register_decoder(ctbot::CommandCodes::CMD_SENS_TRANS, [this](const ctbot::CommandView& cmd, const int64_t timestamp) {
+        push_sample(SLOT_TRANSPORT, cmd.header.data_l, timestamp);
         return true;
     });
 
-    command_eval.register_cmd(ctbot::CommandCodes::CMD_SENS_DOOR, [this](const ctbot::CommandBase& cmd) {
-        // std::cout << "CMD_SENS_DOOR received: " << cmd << "\n";
-        model_.setData(map_[DOOR_.cbegin()], cmd.get_cmd_data_l(), ValueModel::Value);
+    command_eval.register_decoder(ctbot::CommandCodes::CMD_SENS_DOOR, [this](const ctbot::CommandView& cmd, const int64_t timestamp) {
+        push_sample(SLOT_DOOR, cmd.header.data_l, timestamp);
         return true;
     });
 
-    command_eval.register_cmd(ctbot::CommandCodes::CMD_SENS_RC5, [this](const ctbot::CommandBase& cmd) {
-        // std::cout << "CMD_SENS_RC5 received: " << cmd << "\n";
-        model_.setData(map_[RC5_.cbegin()], cmd.get_cmd_data_l(), ValueModel::Value);
+    command_eval.register_decoder(ctbot::CommandCodes::CMD_SENS_RC5, [this](const ctbot::CommandView& cmd, const int64_t timestamp) {
+        push_sample(SLOT_RC5, cmd.header.data_l, timestamp);
         return true;
     });
 
-    command_eval.register_cmd(ctbot::CommandCodes::CMD_SENS_BPS, [this](const ctbot::CommandBase& cmd) {
-        // std::cout << "CMD_SENS_BPS received: " << cmd << "\n";
-        model_.setData(map_[BPS_.cbegin()], cmd.get_cmd_data_l(), ValueModel::Value);
+    command_eval.register_decoder(ctbot::CommandCodes::CMD_SENS_BPS, [this](const ctbot::CommandView& cmd, const int64_t timestamp) {
+        push_sample(SLOT_BPS, cmd.header.data_l, timestamp);
         return true;
     });
 
-    command_eval.register_cmd(ctbot::CommandCodes::CMD_SENS_ERROR, [this](const ctbot::CommandBase& cmd) {
-        // std::cout << "CMD_SENS_ERROR received: " << cmd << "\n";
-        model_.setData(map_[ERROR_.cbegin()], cmd.get_cmd_data_l(), ValueModel::Value);
+    command_eval.register_decoder(ctbot::CommandCodes::CMD_SENS_ERROR, [this](const ctbot::CommandView& cmd, const int64_t timestamp) {
+        push_sample(SLOT_ERROR, cmd.header.data_l, timestamp);
         return true;
     });
 }
 
 
-SensorViewerV2::SensorViewerV2(QQmlApplicationEngine* p_engine, ConnectionManagerV2& command_eval) : ValueViewer { p_engine } {
+SensorViewerV2::SensorViewerV2(QQmlApplicationEngine* p_engine, ConnectionManagerV2& command_eval) : ValueViewer { p_engine, command_eval } {
     qmlRegisterType<ValueModel>("Sensors", 1, 0, "SensorModel");
     qmlRegisterType<ValueModel>("Sensors", 1, 0, "SensorModel");
     qmlRegisterUncreatableType<ValueList>("Sensors", 1, 0, "ValueList", QStringLiteral("Sensors should not be created in QML"));
 
-    list_.appendItem(SPEED_ENC_L_.cbegin());
-    list_.appendItem(SPEED_ENC_R_.cbegin());
-    list_.appendItem(DISTANCE_L_.cbegin());
-    list_.appendItem(DISTANCE_R_.cbegin());
-    list_.appendItem(LINE_L_.cbegin());
-    list_.appendItem(LINE_R_.cbegin());
-    list_.appendItem(BORDER_L_.cbegin());
-    list_.appendItem(BORDER_R_.cbegin());
-    // list_.appendItem(DOOR_.cbegin());
-    list_.appendItem(TRANSPORT_.cbegin());
-    list_.appendItem(TRANSPORT_MM_.cbegin());
-    list_.appendItem(RC5_.cbegin());
-    // list_.appendItem(BPS_.cbegin());
-    list_.appendItem(CURRENT_5V_.cbegin());
-    list_.appendItem(CURRENT_MOTOR_.cbegin());
-    list_.appendItem(CURRENT_SERVO_.cbegin());
-    list_.appendItem(BAT_VOLTAGE_.cbegin());
-    list_.appendItem(BAT_VOLTAGE_CELL_.cbegin());
-
-    update_map();
+    append_slots(SLOT_NAMES_);
     register_model(QStringLiteral("sensorModelV2"));
 
-    command_eval.register_cmd("sens", [this, &command_eval](const std::string_view& str) {
+    /* decoded by the I/O thread, the connection is only established if version 2 is active */
+    command_eval.register_decoder("sens", [this](const std::string_view& str, const int64_t timestamp) {
         // qDebug() << "SENSORS received: " << QString::fromUtf8(str.data(), str.size());
 
-        if (command_eval.get_version() != command_eval.version_active()) {
-            return false;
-        }
-
         if (!str.length()) {
-            return false;
+            return true;
         }
 
-        int16_t values[2];
-        if (parse(str, enc_regex_, values[0], values[1])) {
-            model_.setData(map_[SPEED_ENC_L_.cbegin()], values[0], ValueModel::Value);
-            model_.setData(map_[SPEED_ENC_R_.cbegin()], values[1], ValueModel::Value);
+        const auto fields { parser_.parse(str) };
+        if (fields.has(ENC_)) {
+            push_sample(SLOT_SPEED_ENC_L, fields.get(ENC_, 0), timestamp);
+            push_sample(SLOT_SPEED_ENC_R, fields.get(ENC_, 1), timestamp);
         }
 
-        if (parse(str, dist_regex_, values[0], values[1])) {
-            model_.setData(map_[DISTANCE_L_.cbegin()], values[0], ValueModel::Value);
-            model_.setData(map_[DISTANCE_R_.cbegin()], values[1], ValueModel::Value);
+        if (fields.has(DIST_)) {
+            push_sample(SLOT_DISTANCE_L, fields.get(DIST_, 0), timestamp);
+            push_sample(SLOT_DISTANCE_R, fields.get(DIST_, 1), timestamp);
         }
 
-        if (parse(str, line_regex_, values[0], values[1])) {
-            model_.setData(map_[LINE_L_.cbegin()], values[0], ValueModel::Value);
-            model_.setData(map_[LINE_R_.cbegin()], values[1], ValueModel::Value);
+        if (fields.has(LINE_)) {
+            push_sample(SLOT_LINE_L, fields.get(LINE_, 0), timestamp);
+            push_sample(SLOT_LINE_R, fields.get(LINE_, 1), timestamp);
         }
 
-        if (parse(str, border_regex_, values[0], values[1])) {
-            model_.setData(map_[BORDER_L_.cbegin()], values[0], ValueModel::Value);
-            model_.setData(map_[BORDER_R_.cbegin()], values[1], ValueModel::Value);
+        if (fields.has(BORDER_)) {
+            push_sample(SLOT_BORDER_L, fields.get(BORDER_, 0), timestamp);
+            push_sample(SLOT_BORDER_R, fields.get(BORDER_, 1), timestamp);
         }
 
         // Door
 
-        if (parse(str, trans_regex_, values[0], values[1])) {
-            model_.setData(map_[TRANSPORT_.cbegin()], values[0], ValueModel::Value);
-            model_.setData(map_[TRANSPORT_MM_.cbegin()], values[1], ValueModel::Value);
+        if (fields.has(TRANS_)) {
+            push_sample(SLOT_TRANSPORT, fields.get(TRANS_, 0), timestamp);
+            push_sample(SLOT_TRANSPORT_MM, fields.get(TRANS_, 1), timestamp);
         }
 
-        if (parse(str, rc5_regex_, values[0], values[1])) {
-            model_.setData(map_[RC5_.cbegin()], values[1], ValueModel::Value);
+        if (fields.has(RC5_CMD_)) {
+            push_sample(SLOT_RC5, fields.get(RC5_CMD_, 1), timestamp);
         }
 
         // BPS
 
-        if (parse(str, currents_regex_, values[0], values[1])) {
-            model_.setData(map_[CURRENT_5V_.cbegin()], values[0], ValueModel::Value);
-            model_.setData(map_[CURRENT_SERVO_.cbegin()], values[1], ValueModel::Value);
+        if (fields.has(CURRENTS_)) {
+            push_sample(SLOT_CURRENT_5V, fields.get(CURRENTS_, 0), timestamp);
+            push_sample(SLOT_CURRENT_SERVO, fields.get(CURRENTS_, 1), timestamp);
         }
 
-        if (parse(str, mcurrent_regex_, values[0])) {
-            model_.setData(map_[CURRENT_MOTOR_.cbegin()], values[0], ValueModel::Value);
+        if (fields.has(MCURRENT_)) {
+            push_sample(SLOT_CURRENT_MOTOR, fields.get(MCURRENT_), timestamp);
         }
 
-        float bat[2];
-        if (parse(str, bat_regex_, bat[0], bat[1])) {
-            model_.setData(map_[BAT_VOLTAGE_.cbegin()], static_cast<int>(bat[0] * 1'000.f), ValueModel::Value);
-            model_.setData(map_[BAT_VOLTAGE_CELL_.cbegin()], static_cast<int>(bat[1] * 1'000.f), ValueModel::Value);
-            // qDebug() << "Bat=" << bat[0] << " " << bat[1];
+        if (fields.has(BAT_)) {
+            push_sample(SLOT_BAT_VOLTAGE, static_cast<int>(fields.get(BAT_, 0) * 1'000.f), timestamp);
+            push_sample(SLOT_BAT_VOLTAGE_CELL, static_cast<int>(fields.get(BAT_, 1) * 1'000.f), timestamp);
+            // qDebug() << "Bat=" << fields.get(BAT_, 0) << " " << fields.get(BAT_, 1);
         }
 
         return true;
@@ -25,9 +25,10 @@
 #pragma once
 
 #include "value_viewer.h"
+#include "field_parser.h"
 
+#include <array>
 #include <string_view>
-#include <regex>
 
 
 class ConnectionManagerV1;
@@ -53,6 +54,47 @@ protected:
     static constexpr std::string_view BPS_ { "BPS" };
     static constexpr std::string_view ERROR_ { "Error" };
 
+    enum Slot : int {
+        SLOT_SPEED_ENC_L,
+        SLOT_SPEED_ENC_R,
+        SLOT_DISTANCE_L,
+        SLOT_DISTANCE_R,
+        SLOT_LINE_L,
+        SLOT_LINE_R,
+        SLOT_BORDER_L,
+        SLOT_BORDER_R,
+        SLOT_LIGHT_L,
+        SLOT_LIGHT_R,
+        SLOT_MOUSE_DX,
+        SLOT_MOUSE_DY,
+        SLOT_DOOR,
+        SLOT_TRANSPORT,
+        SLOT_RC5,
+        SLOT_BPS,
+        SLOT_ERROR,
+        NUM_SLOTS
+    };
+    static constexpr std::array SLOT_NAMES_ {
+        SPEED_ENC_L_,
+        SPEED_ENC_R_,
+        DISTANCE_L_,
+        DISTANCE_R_,
+        LINE_L_,
+        LINE_R_,
+        BORDER_L_,
+        BORDER_R_,
+        LIGHT_L_,
+        LIGHT_R_,
+        MOUSE_DX_,
+        MOUSE_DY_,
+        DOOR_,
+        TRANSPORT_,
+        RC5_,
+        BPS_,
+        ERROR_,
+    };
+    static_assert(SLOT_NAMES_.size() == NUM_SLOTS);
+
 public:
     SensorViewerV1(QQmlApplicationEngine* p_engine, ConnectionManagerV1& command_eval);
 };
@@ -62,41 +104,82 @@ class SensorViewerV2 : public ValueViewer {
 protected:
     static constexpr std::string_view SPEED_ENC_L_ { "Speed enc left [mm/s]" };
     static constexpr std::string_view SPEED_ENC_R_ { "Speed enc right [mm/s]" };
-    static constexpr std::string_view SPEED_ENC_RE_ { R"(enc: (-?\d*) (-?\d*))" };
     static constexpr std::string_view DISTANCE_L_ { "Distance left [mm]" };
     static constexpr std::string_view DISTANCE_R_ { "Distance right [mm]" };
-    static constexpr std::string_view DISTANCE_RE_ { R"(dist: (\d*) (\d*))" };
     static constexpr std::string_view LINE_L_ { "Line left" };
     static constexpr std::string_view LINE_R_ { "Line right" };
-    static constexpr std::string_view LINE_RE_ { R"(line: (\d*) (\d*))" };
     static constexpr std::string_view BORDER_L_ { "Border left" };
     static constexpr std::string_view BORDER_R_ { "Border right" };
-    static constexpr std::string_view BORDER_RE_ { R"(border: (\d*) (\d*))" };
     static constexpr std::string_view DOOR_ { "Door" };
     static constexpr std::string_view TRANSPORT_ { "Transport pocket" };
     static constexpr std::string_view TRANSPORT_MM_ { "Transport pocket [mm]" };
-    static constexpr std::string_view TRANSPORT_RE_ { R"(trans: (\d*) (\d*))" };
     static constexpr std::string_view RC5_ { "RC-5 Command" };
-    static constexpr std::string_view RC5_RE_ { R"(rc5: (\d*) (\d*) (?:\d*))" };
     static constexpr std::string_view BPS_ { "BPS" };
     static constexpr std::string_view CURRENT_5V_ { "5V rail current [mA]" };
     static constexpr std::string_view CURRENT_SERVO_ { "Servo current [mA]" };
-    static constexpr std::string_view CURRENT_RE_ { R"(currents: (\d*) (\d*))" };
     static constexpr std::string_view CURRENT_MOTOR_ { "Motor current [mA]" };
-    static constexpr std::string_view CURRENT_MOTOR_RE_ { R"(mcurrent: (\d*))" };
     static constexpr std::string_view BAT_VOLTAGE_ { "Battery [mV]" };
     static constexpr std::string_view BAT_VOLTAGE_CELL_ { "Battery (per cell) [mV]" };
-    static constexpr std::string_view BAT_VOLTAGE_RE_ { R"(bat: (\d*\.\d*) (\d*\.\d*))" };
 
-    static inline const std::regex enc_regex_ { SPEED_ENC_RE_.cbegin() };
-    static inline const std::regex dist_regex_ { DISTANCE_RE_.cbegin() };
-    static inline const std::regex line_regex_ { LINE_RE_.cbegin() };
-    static inline const std::regex border_regex_ { BORDER_RE_.cbegin() };
-    static inline const std::regex trans_regex_ { TRANSPORT_RE_.cbegin() };
-    static inline const std::regex rc5_regex_ { RC5_RE_.cbegin() };
-    static inline const std::regex bat_regex_ { BAT_VOLTAGE_RE_.cbegin() };
-    static inline const std::regex currents_regex_ { CURRENT_RE_.cbegin() };
-    static inline const std::regex mcurrent_regex_ { CURRENT_MOTOR_RE_.cbegin() };
+    enum Slot : int {
+        SLOT_SPEED_ENC_L,
+        SLOT_SPEED_ENC_R,
+        SLOT_DISTANCE_L,
+        SLOT_DISTANCE_R,
+        SLOT_LINE_L,
+        SLOT_LINE_R,
+        SLOT_BORDER_L,
+        SLOT_BORDER_R,
+        SLOT_TRANSPORT,
+        SLOT_TRANSPORT_MM,
+        SLOT_RC5,
+        SLOT_CURRENT_5V,
+        SLOT_CURRENT_MOTOR,
+        SLOT_CURRENT_SERVO,
+        SLOT_BAT_VOLTAGE,
+        SLOT_BAT_VOLTAGE_CELL,
+        NUM_SLOTS
+    };
+    static constexpr std::array SLOT_NAMES_ {
+        SPEED_ENC_L_,
+        SPEED_ENC_R_,
+        DISTANCE_L_,
+        DISTANCE_R_,
+        LINE_L_,
+        LINE_R_,
+        BORDER_L_,
+        BORDER_R_,
+        TRANSPORT_,
+        TRANSPORT_MM_,
+        RC5_,
+        CURRENT_5V_,
+        CURRENT_MOTOR_,
+        CURRENT_SERVO_,
+        BAT_VOLTAGE_,
+        BAT_VOLTAGE_CELL_,
+    };
+    static_assert(SLOT_NAMES_.size() == NUM_SLOTS);
+
+    static constexpr FieldParser parser_ { std::array {
+        FieldSpec { "enc", 2 },
+        FieldSpec { "dist", 2 },
+        FieldSpec { "line", 2 },
+        FieldSpec { "border", 2 },
+        FieldSpec { "trans", 2 },
+        FieldSpec { "rc5", 2 },
+        FieldSpec { "currents", 2 },
+        FieldSpec { "mcurrent", 1 },
+        FieldSpec { "bat", 2, FieldType::FLOAT },
+    } };
+    static constexpr size_t ENC_ { parser_.index("enc") };
+    static constexpr size_t DIST_ { parser_.index("dist") };
+    static constexpr size_t LINE_ { parser_.index("line") };
+    static constexpr size_t BORDER_ { parser_.index("border") };
+    static constexpr size_t TRANS_ { parser_.index("trans") };
+    static constexpr size_t RC5_CMD_ { parser_.index("rc5") };
+    static constexpr size_t CURRENTS_ { parser_.index("currents") };
+    static constexpr size_t MCURRENT_ { parser_.index("mcurrent") };
+    static constexpr size_t BAT_ { parser_.index("bat") };
 
 public:
     SensorViewerV2(QQmlApplicationEngine* p_engine, ConnectionManagerV2& command_eval);
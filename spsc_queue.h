@@ -0,0 +1,95 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    spsc_queue.h
+ * @brief   Lock-free single producer, single consumer queue
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+
+/**
+ * @brief Fixed-capacity ring buffer for passing elements from one thread to another without locking
+ *
+ * push() may only be called by one (producer) thread and pop() by one other (consumer) thread. Elements are moved into and out of the slots.
+ * @tparam T: Type of elements, default constructible and move assignable
+ * @tparam N: Capacity, power of 2
+ */
+template <typename T, size_t N>
+class SpscQueue {
+    static_assert(N && (N & (N - 1)) == 0, "capacity has to be a power of 2");
+
+    std::array<T, N> slots_;
+    alignas(64) std::atomic<size_t> head_; /**< next element to pop, written by consumer */
+    alignas(64) std::atomic<size_t> tail_; /**< next slot to push to, written by producer */
+
+public:
+    SpscQueue() : slots_ {}, head_ {}, tail_ {} {}
+
+    /**
+     * @brief Append an element, producer only
+     * @return false, if the queue is full
+     */
+    bool push(T&& value) {
+        const auto tail { tail_.load(std::memory_order_relaxed) };
+        if (tail - head_.load(std::memory_order_acquire) == N) {
+            return false;
+        }
+
+        slots_[tail & (N - 1)] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Remove the oldest element, consumer only
+     * @return false, if the queue is empty
+     */
+    bool pop(T& value) {
+        const auto head { head_.load(std::memory_order_relaxed) };
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        value = std::move(slots_[head & (N - 1)]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @return Number of elements, exact only if called by the producer or consumer while the other thread is idle
+     */
+    size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    bool full() const {
+        return size() == N;
+    }
+
+    static constexpr size_t capacity() {
+        return N;
+    }
+};
@@ -28,16 +28,17 @@
 
 #include <charconv>
 #include <cstring>
-#include <clocale>
 #include <iostream>
+#include <utility>
 
 #include "system_viewer.h"
 #include "connection_manager.h"
 #include "command.h"
+#include "field_parser.h"
 
 
 SystemViewerV2::SystemViewerV2(QQmlApplicationEngine* p_engine, ConnectionManagerV2& command_eval)
-    : ValueViewer { p_engine }, p_cpu_util_ {}, last_cpu_util_ { -1.f }, p_ram_util_ {}, last_ram1_ {}, last_ram2_ {}, last_ram3_ {} {
+    : ValueViewer { p_engine, command_eval }, p_cpu_util_ {}, last_cpu_util_ { -1.f }, p_ram_util_ {}, last_ram1_ {}, last_ram2_ {}, last_ram3_ {} {
     qmlRegisterType<ValueModel>("SystemData", 1, 0, "SystemDataModel");
     qmlRegisterUncreatableType<ValueList>("SystemData", 1, 0, "ValueList", QStringLiteral("SystemData should not be created in QML"));
 
@@ -72,8 +73,10 @@ SystemViewerV2::SystemViewerV2(QQmlApplicationEngine* p_engine, ConnectionManage
                     list_.appendItem(id_string);
                     update_map();
                 }
+                model_.beginUpdate();
                 model_.setData(map_[id_string], task_name, ValueModel::Name);
                 model_.setData(map_[id_string], task_util, ValueModel::Value);
+                model_.endUpdate();
             }
         }
 
@@ -133,15 +136,16 @@ void SystemViewerV2::init() {
 bool SystemViewerV2::parse(const std::string_view& str, const std::regex& regex, int32_t& id, QString& name, float& value) const {
     std::match_results<std::string_view::const_iterator> matches;
     if (std::regex_search(str.cbegin(), str.cend(), matches, regex)) {
-        const char* old_locale { std::setlocale(LC_ALL, nullptr) };
-        std::setlocale(LC_ALL, "C");
-        auto [ptr, ec] { std::from_chars(matches[1].str().c_str(), matches[1].str().c_str() + matches[1].str().size(), id) };
+        const auto p_id { str.data() + matches.position(1) };
+        auto [ptr, ec] { std::from_chars(p_id, p_id + matches.length(1), id) };
         if (ec != std::errc()) {
             return false;
         }
-        name = QString::fromStdString(matches[2].str());
-        value = std::strtof(matches[3].str().c_str(), nullptr);
-        std::setlocale(LC_ALL, old_locale);
+        name = QString::fromUtf8(str.data() + matches.position(2), matches.length(2));
+        const auto p_value { str.data() + matches.position(3) };
+        if (!parse_float(p_value, p_value + matches.length(3), value)) {
+            return false;
+        }
     } else {
         return false;
     }
@@ -153,31 +157,43 @@ bool SystemViewerV2::parse(
     const std::string_view& str, const std::regex& regex, int32_t& id, size_t& v1, size_t& v2, size_t& v3, size_t& v4, size_t& v5) const {
     std::match_results<std::string_view::const_iterator> matches;
     if (std::regex_search(str.cbegin(), str.cend(), matches, regex)) {
-        const char* old_locale { std::setlocale(LC_ALL, nullptr) };
-        std::setlocale(LC_ALL, "C");
+        const auto match { [&str, &matches](const size_t n) {
+            const auto p_begin { str.data() + matches.position(n) };
+            return std::make_pair(p_begin, p_begin + matches.length(n));
+        } };
         {
-            auto [ptr, ec] { std::from_chars(matches[1].str().c_str(), matches[1].str().c_str() + matches[1].str().size(), id) };
+            const auto [p_begin, p_end] { match(1) };
+            auto [ptr, ec] { std::from_chars(p_begin, p_end, id) };
             if (ec != std::errc()) {
                 return false;
             }
         }
         {
-            auto [ptr, ec] { std::from_chars(matches[2].str().c_str(), matches[2].str().c_str() + matches[2].str().size(), v1) };
+            const auto [p_begin, p_end] { match(2) };
+            auto [ptr, ec] { std::from_chars(p_begin, p_end, v1) };
             if (ec != std::errc()) {
                 return false;
             }
         }
         {
-            auto [ptr, ec] { std::from_chars(matches[3].str().c_str(), matches[3].str().c_str() + matches[3].str().size(), v2) };
+            const auto [p_begin, p_end] { match(3) };
+            auto [ptr, ec] { std::from_chars(p_begin, p_end, v2) };
             if (ec != std::errc()) {
                 return false;
             }
         }
-        std::from_chars(matches[4].str().c_str(), matches[4].str().c_str() + matches[4].str().size(), v3);
-        std::from_chars(matches[5].str().c_str(), matches[5].str().c_str() + matches[5].str().size(), v4);
-        std::from_chars(matches[6].str().c_str(), matches[6].str().c_str() + matches[6].str().size(), v5);
-
-        std::setlocale(LC_ALL, old_locale);
+        {
+            const auto [p_begin, p_end] { match(4) };
+            std::from_chars(p_begin, p_end, v3);
+        }
+        {
+            const auto [p_begin, p_end] { match(5) };
+            std::from_chars(p_begin, p_end, v4);
+        }
+        {
+            const auto [p_begin, p_end] { match(6) };
+            std::from_chars(p_begin, p_end, v5);
+        }
     } else {
         return false;
     }
@@ -0,0 +1,150 @@
+/*
+ * This file is part of the ct-Bot remote viewer tool.
+ * Copyright (c) 2020-2022 Timo Sandmann
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file    telemetry_ring.h
+ * @brief   Lock-free ring of decoded telemetry samples
+ * @author  Timo Sandmann
+ * @date    17.10.2026
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+
+/**
+ * @brief Decoded telemetry value
+ */
+struct TelemetrySample {
+    int64_t timestamp; /**< time of reception in ns */
+    uint16_t slot; /**< slot ID of the receiving viewer */
+    float value;
+};
+static_assert(std::is_trivially_copyable_v<TelemetrySample>);
+
+
+/**
+ * @brief Fixed-capacity ring of telemetry samples from one producer (the I/O thread) to one consumer (the GUI thread)
+ *
+ * The producer never waits: if the consumer falls behind, the oldest samples are overwritten. Every cell is protected by a sequence number, so
+ * the consumer detects cells overwritten while reading them and skips them. Samples are stored in atomic words, so there is no data race even if
+ * a cell is overwritten concurrently.
+ * @tparam N: Capacity, power of 2
+ */
+template <size_t N>
+class TelemetryRing {
+    static_assert(N && (N & (N - 1)) == 0, "capacity has to be a power of 2");
+
+public:
+    struct Statistics {
+        uint64_t pushed; /**< number of samples written */
+        uint64_t popped; /**< number of samples read */
+        uint64_t overwritten; /**< number of samples lost because the consumer was too slow */
+        uint64_t max_fill; /**< maximum number of samples waiting to be read */
+    };
+
+    TelemetryRing() : cells_ {}, write_pos_ {}, max_fill_ {}, read_pos_ {}, popped_ {}, overwritten_ {} {}
+
+    /**
+     * @brief Append a sample, overwrites the oldest one if full; producer only
+     */
+    void push(const TelemetrySample& sample) {
+        const auto pos { write_pos_.load(std::memory_order_relaxed) };
+        auto& cell { cells_[pos & (N - 1)] };
+
+        /* odd sequence number marks the cell as being written */
+        cell.seq.store(2 * pos + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        cell.timestamp.store(sample.timestamp, std::memory_order_relaxed);
+        cell.data.store((static_cast<uint64_t>(sample.slot) << 32) | std::bit_cast<uint32_t>(sample.value), std::memory_order_relaxed);
+        cell.seq.store(2 * pos + 2, std::memory_order_release);
+        write_pos_.store(pos + 1, std::memory_order_release);
+
+        const auto fill { std::min<uint64_t>(pos + 1 - read_pos_.load(std::memory_order_relaxed), N) };
+        if (fill > max_fill_.load(std::memory_order_relaxed)) {
+            max_fill_.store(fill, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Remove the oldest sample still available; consumer only
+     * @return false, if the ring is empty
+     */
+    bool pop(TelemetrySample& sample) {
+        while (true) {
+            auto pos { read_pos_.load(std::memory_order_relaxed) };
+            const auto end { write_pos_.load(std::memory_order_acquire) };
+            if (pos == end) {
+                return false;
+            }
+            if (end - pos > N) {
+                /* overtaken by the producer */
+                overwritten_ += end - pos - N;
+                pos = end - N;
+            }
+
+            const auto& cell { cells_[pos & (N - 1)] };
+            const auto seq { cell.seq.load(std::memory_order_acquire) };
+            const auto timestamp { cell.timestamp.load(std::memory_order_relaxed) };
+            const auto data { cell.data.load(std::memory_order_relaxed) };
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const bool valid { seq == 2 * pos + 2 && cell.seq.load(std::memory_order_relaxed) == seq };
+
+            read_pos_.store(pos + 1, std::memory_order_relaxed);
+            if (!valid) {
+                ++overwritten_;
+                continue;
+            }
+
+            sample = TelemetrySample { timestamp, static_cast<uint16_t>(data >> 32), std::bit_cast<float>(static_cast<uint32_t>(data)) };
+            ++popped_;
+            return true;
+        }
+    }
+
+    /**
+     * @return Statistics, consumer only
+     */
+    Statistics get_statistics() const {
+        return Statistics { write_pos_.load(std::memory_order_relaxed), popped_, overwritten_, max_fill_.load(std::memory_order_relaxed) };
+    }
+
+    static constexpr size_t capacity() {
+        return N;
+    }
+
+private:
+    struct Cell {
+        std::atomic<uint64_t> seq; /**< 2 * position + 2 if valid, odd while written */
+        std::atomic<int64_t> timestamp;
+        std::atomic<uint64_t> data; /**< slot in upper, value in lower 32 bit */
+    };
+
+    std::array<Cell, N> cells_;
+    alignas(64) std::atomic<uint64_t> write_pos_; /**< written by producer */
+    std::atomic<uint64_t> max_fill_;
+    alignas(64) std::atomic<uint64_t> read_pos_; /**< written by consumer */
+    uint64_t popped_;
+    uint64_t overwritten_;
+};
@@ -47,6 +47,34 @@ bool ValueList::setItemAt(int index, const ViewerItem& item) {
     return true;
 }
 
+bool ValueList::setValueAt(int index, float value) {
+    if (index < 0 || index >= items_.size()) {
+        return false;
+    }
+
+    ViewerItem& item = items_[index];
+    if (item.value == value) {
+        return false;
+    }
+
+    item.value = value;
+    return true;
+}
+
+bool ValueList::setNameAt(int index, const QString& name) {
+    if (index < 0 || index >= items_.size()) {
+        return false;
+    }
+
+    ViewerItem& item = items_[index];
+    if (item.name == name) {
+        return false;
+    }
+
+    item.name = name;
+    return true;
+}
+
 // bool ValueList::updateItemAt(int index, const int value) {
 //    if (index < 0 || index >= items_.size()) {
 //        return false;
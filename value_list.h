@@ -47,6 +47,8 @@ public:
     const QList<ViewerItem>& items() const;
 
     bool setItemAt(int index, const ViewerItem& item);
+    bool setValueAt(int index, float value);
+    bool setNameAt(int index, const QString& name);
     // bool updateItemAt(int index, const int value);
 
     void sort();
@@ -24,10 +24,28 @@
 
 #include <QDebug>
 
+#include <algorithm>
+
 #include "value_model.h"
 
 
-ValueModel::ValueModel(QObject* parent) : QAbstractListModel { parent }, list_ {} {}
+ValueModel::ValueModel(QObject* parent)
+    : QAbstractListModel { parent }, list_ {}, batch_depth_ {}, dirty_first_ { -1 }, dirty_last_ { -1 }, dirty_roles_ {}, signal_count_ {}, signal_rate_ {} {
+    flush_timer_.setSingleShot(true);
+    flush_timer_.setInterval(0);
+    connect(&flush_timer_, &QTimer::timeout, this, &ValueModel::flush);
+
+    stats_timer_.setInterval(1'000);
+    connect(&stats_timer_, &QTimer::timeout, this, [this]() {
+        const int rate { static_cast<int>(signal_count_) };
+        signal_count_ = 0;
+        if (rate != signal_rate_) {
+            signal_rate_ = rate;
+            emit signalRateChanged();
+        }
+    });
+    stats_timer_.start();
+}
 
 int ValueModel::rowCount(const QModelIndex& parent) const {
     // For list models only the root node (an invalid parent) should return the list's size. For all
@@ -44,7 +62,7 @@ QVariant ValueModel::data(const QModelIndex& index, int role) const {
         return QVariant {};
     }
 
-    const ViewerItem item { list_->items().at(index.row()) };
+    const ViewerItem& item { list_->items().at(index.row()) };
 
     switch (role) {
         case Name: return QVariant(item.name);
@@ -59,22 +77,97 @@ bool ValueModel::setData(const QModelIndex& index, const QVariant& value, int ro
         return false;
     }
 
-    ViewerItem item { list_->items().at(index.row()) };
-    // qDebug() << "ValueModel::setData(): item={\"" << item.name << "\", " << item.value << "}"
-    //          << "role=" << role;
-
+    bool changed {};
     switch (role) {
-        case Name: item.name = value.toString(); break;
-        case Value: item.value = value.toFloat(); break;
+        case Name: changed = list_->setNameAt(index.row(), value.toString()); break;
+        case Value: changed = list_->setValueAt(index.row(), value.toFloat()); break;
+    }
+
+    if (changed) {
+        // qDebug() << "ValueModel::setData(): row=" << index.row() << "role=" << role << "value=" << value;
+        mark_dirty(index.row(), role);
+    }
+
+    return changed;
+}
+
+bool ValueModel::setValue(int row, float value) {
+    if (!list_ || !list_->setValueAt(row, value)) {
+        return false;
+    }
+
+    mark_dirty(row, Value);
+    return true;
+}
+
+void ValueModel::beginUpdate() {
+    ++batch_depth_;
+}
+
+void ValueModel::endUpdate() {
+    if (batch_depth_ && !--batch_depth_ && dirty_first_ >= 0) {
+        schedule_flush();
+    }
+}
+
+void ValueModel::setUpdateInterval(int ms) {
+    flush_timer_.setInterval(ms);
+}
+
+int ValueModel::signalRate() const {
+    return signal_rate_;
+}
+
+void ValueModel::mark_dirty(int row, int role) {
+    if (dirty_first_ < 0) {
+        dirty_first_ = row;
+        dirty_last_ = row;
+    } else {
+        dirty_first_ = std::min(dirty_first_, row);
+        dirty_last_ = std::max(dirty_last_, row);
+    }
+    dirty_roles_ |= 1 << role;
+
+    if (!batch_depth_) {
+        schedule_flush();
     }
+}
 
-    if (list_->setItemAt(index.row(), item)) {
-        // qDebug() << "ValueModel::setData(): item={" << item.name << ", " << item.value << "}";
-        emit dataChanged(index, index, QVector<int>() << role);
-        return true;
+void ValueModel::schedule_flush() {
+    if (flush_timer_.interval() > 0) {
+        if (!flush_timer_.isActive()) {
+            flush_timer_.start();
+        }
+    } else {
+        flush();
+    }
+}
+
+void ValueModel::discard_pending() {
+    flush_timer_.stop();
+    dirty_first_ = -1;
+    dirty_last_ = -1;
+    dirty_roles_ = 0;
+}
+
+void ValueModel::flush() {
+    if (dirty_first_ < 0) {
+        return;
+    }
+
+    QList<int> roles;
+    if (dirty_roles_ & (1 << Name)) {
+        roles << Name;
+    }
+    if (dirty_roles_ & (1 << Value)) {
+        roles << Value;
     }
+    const auto first { index(dirty_first_, 0) };
+    const auto last { index(dirty_last_, 0) };
+    discard_pending();
 
-    return false;
+    emit dataChanged(first, last, roles);
+    ++signal_count_;
 }
 
 Qt::ItemFlags ValueModel::flags(const QModelIndex& index) const {
@@ -98,6 +191,7 @@ ValueList* ValueModel::list() const {
 
 void ValueModel::setList(ValueList* list) {
     beginResetModel();
+    discard_pending();
 
     if (list_) {
         list_->disconnect(this);
@@ -119,6 +213,7 @@ void ValueModel::setList(ValueList* list) {
 
 void ValueModel::sort() {
     beginResetModel();
+    discard_pending();
 
     list_->sort();
 
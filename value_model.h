@@ -25,6 +25,9 @@
 #pragma once
 
 #include <QAbstractListModel>
+#include <QTimer>
+
+#include <cstdint>
 
 #include "value_list.h"
 
@@ -32,6 +35,7 @@
 class ValueModel : public QAbstractListModel {
     Q_OBJECT
     Q_PROPERTY(ValueList* list READ list WRITE setList NOTIFY listChanged)
+    Q_PROPERTY(int signalRate READ signalRate NOTIFY signalRateChanged)
 
 public:
     explicit ValueModel(QObject* parent = nullptr);
@@ -56,9 +60,46 @@ public:
 
     void sort();
 
+    /**
+     * @brief Start a batch of changes, dataChanged() is delayed until the matching endUpdate()
+     */
+    void beginUpdate();
+
+    /**
+     * @brief Finish a batch of changes, emits one dataChanged() for the range of all changed rows
+     */
+    void endUpdate();
+
+    bool setValue(int row, float value);
+
+    /**
+     * @brief Set minimum interval between two dataChanged() signals
+     * @param[in] ms: Interval in ms, changes are signaled at most once per interval; 0 to signal at the end of each batch
+     */
+    void setUpdateInterval(int ms);
+
+    /**
+     * @return Number of dataChanged() signals emitted during the last second
+     */
+    int signalRate() const;
+
 signals:
     void listChanged();
+    void signalRateChanged();
 
 private:
     ValueList* list_;
+    int batch_depth_;
+    int dirty_first_;
+    int dirty_last_;
+    uint8_t dirty_roles_;
+    uint32_t signal_count_;
+    int signal_rate_;
+    QTimer flush_timer_;
+    QTimer stats_timer_;
+
+    void mark_dirty(int row, int role);
+    void schedule_flush();
+    void discard_pending();
+    void flush();
 };
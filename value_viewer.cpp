@@ -25,89 +25,67 @@
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
 
-#include <charconv>
-#include <cstdlib>
-#include <clocale>
+#include <algorithm>
 
 #include "value_viewer.h"
+#include "connection_manager.h"
 
 
-ValueViewer::ValueViewer(QQmlApplicationEngine* p_engine) : p_engine_ { p_engine } {
+ValueViewer::ValueViewer(QQmlApplicationEngine* p_engine, ConnectionManagerBase& connection)
+    : p_engine_ { p_engine }, connection_ { connection }, slot_stats_ {}, refresh_scheduled_ {} {
     model_.setList(&list_);
-}
 
-void ValueViewer::update_map() {
-    for (int i {}; i < model_.rowCount(); ++i) {
-        const auto& e { model_.data(model_.index(i, 0), ValueModel::Name) };
-        map_[e.toString()] = model_.index(i, 0);
-    }
+    refresh_timer_.setSingleShot(true);
+    QObject::connect(&refresh_timer_, &QTimer::timeout, &model_, [this]() { refresh(); });
 }
 
-void ValueViewer::register_model(const QString& modelname) {
-    p_engine_->rootContext()->setContextProperty(modelname, &model_);
-}
-
-bool ValueViewer::parse(const std::string_view& str, const std::regex& regex, int16_t& value) const {
-    std::match_results<std::string_view::const_iterator> matches;
-    if (std::regex_search(str.cbegin(), str.cend(), matches, regex)) {
-        auto [ptr, ec] { std::from_chars(matches[1].str().c_str(), matches[1].str().c_str() + matches[1].str().size(), value) };
-        if (ec != std::errc()) {
-            return false;
-        }
-    } else {
-        return false;
+void ValueViewer::push_sample(const int slot, const float value, const int64_t timestamp) {
+    latest_.store(static_cast<size_t>(slot), value);
+    telemetry_.push(TelemetrySample { timestamp, static_cast<uint16_t>(slot), value });
+
+    if (!refresh_scheduled_.exchange(true)) {
+        QMetaObject::invokeMethod(
+            &model_,
+            [this]() {
+                /* at most one refresh per frame, no matter how many samples arrive meanwhile */
+                const auto elapsed { refresh_clock_.isValid() ? refresh_clock_.elapsed() : MODEL_UPDATE_INTERVAL_MS_ };
+                refresh_timer_.start(static_cast<int>(std::max<qint64>(0, MODEL_UPDATE_INTERVAL_MS_ - elapsed)));
+            },
+            Qt::QueuedConnection);
     }
-
-    return true;
 }
 
-bool ValueViewer::parse(const std::string_view& str, const std::regex& regex, int16_t& left, int16_t& right) const {
-    std::match_results<std::string_view::const_iterator> matches;
-    if (std::regex_search(str.cbegin(), str.cend(), matches, regex)) {
-        {
-            auto [ptr, ec] { std::from_chars(matches[1].str().c_str(), matches[1].str().c_str() + matches[1].str().size(), left) };
-            if (ec != std::errc()) {
-                return false;
-            }
-        }
-        {
-            auto [ptr, ec] { std::from_chars(matches[2].str().c_str(), matches[2].str().c_str() + matches[2].str().size(), right) };
-            if (ec != std::errc()) {
-                return false;
-            }
-        }
-    } else {
-        return false;
+void ValueViewer::refresh() {
+    refresh_scheduled_ = false;
+    refresh_clock_.start();
+
+    model_.beginUpdate();
+    latest_.collect([this](const size_t slot, const float value) {
+        model_.setValue(static_cast<int>(slot), value);
+        ++slot_stats_[slot].shown;
+    });
+    model_.endUpdate();
+
+    /* intermediate samples only go to the statistics and the latency histogram of the connection */
+    TelemetrySample sample;
+    while (telemetry_.pop(sample)) {
+        connection_.add_latency(sample.timestamp);
+        auto& stats { slot_stats_[sample.slot] };
+        stats.min = stats.samples ? std::min(stats.min, sample.value) : sample.value;
+        stats.max = stats.samples ? std::max(stats.max, sample.value) : sample.value;
+        stats.last = sample.value;
+        stats.last_timestamp = sample.timestamp;
+        ++stats.samples;
     }
-
-    return true;
 }
 
-bool ValueViewer::parse(const std::string_view& str, const std::regex& regex, float& value) const {
-    std::match_results<std::string_view::const_iterator> matches;
-    if (std::regex_search(str.cbegin(), str.cend(), matches, regex)) {
-        const char* old_locale { std::setlocale(LC_ALL, nullptr) };
-        std::setlocale(LC_ALL, "C");
-        value = std::strtof(matches[1].str().c_str(), nullptr);
-        std::setlocale(LC_ALL, old_locale);
-    } else {
-        return false;
+void ValueViewer::update_map() {
+    for (int i {}; i < model_.rowCount(); ++i) {
+        const auto& e { model_.data(model_.index(i, 0), ValueModel::Name) };
+        map_[e.toString()] = model_.index(i, 0);
     }
-
-    return true;
 }
 
-bool ValueViewer::parse(const std::string_view& str, const std::regex& regex, float& value1, float& value2) const {
-    std::match_results<std::string_view::const_iterator> matches;
-    if (std::regex_search(str.cbegin(), str.cend(), matches, regex)) {
-        const char* old_locale { std::setlocale(LC_ALL, nullptr) };
-        std::setlocale(LC_ALL, "C");
-        value1 = std::strtof(matches[1].str().c_str(), nullptr);
-        value2 = std::strtof(matches[2].str().c_str(), nullptr);
-        std::setlocale(LC_ALL, old_locale);
-    } else {
-        return false;
-    }
-
-    return true;
+void ValueViewer::register_model(const QString& modelname) {
+    p_engine_->rootContext()->setContextProperty(modelname, &model_);
 }
@@ -27,29 +27,91 @@
 #include <QString>
 #include <QHash>
 #include <QModelIndex>
+#include <QElapsedTimer>
+#include <QTimer>
 
-#include <regex>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string_view>
 
+#include "latest_value_table.h"
+#include "telemetry_ring.h"
 #include "value_model.h"
 #include "value_list.h"
 
 
 class QQmlApplicationEngine;
+class ConnectionManagerBase;
 
 class ValueViewer {
+public:
+    static constexpr size_t MAX_SLOTS_ { 64 };
+
+    struct SlotStatistics {
+        uint64_t samples; /**< number of values received */
+        uint64_t shown; /**< number of values passed to the model */
+        float min;
+        float max;
+        float last;
+        int64_t last_timestamp; /**< time of reception of last value in ns */
+    };
+
 protected:
+    static constexpr int MODEL_UPDATE_INTERVAL_MS_ { 16 }; /**< one update per display refresh at 60 Hz */
+    static constexpr size_t TELEMETRY_SIZE_ { 1024 };
+
     QQmlApplicationEngine* p_engine_;
+    ConnectionManagerBase& connection_; /**< connection running the decoders, receives the latencies of the decoded values */
     ValueList list_;
     ValueModel model_;
-    QHash<QString, QModelIndex> map_;
+    QHash<QString, QModelIndex> map_; /**< name based row lookup, only used for rows added at runtime */
+    LatestValueTable<MAX_SLOTS_> latest_; /**< latest value per slot from decoders running in the I/O thread, shown once per frame */
+    TelemetryRing<TELEMETRY_SIZE_> telemetry_; /**< all samples from decoders, used for statistics only */
+    std::array<SlotStatistics, MAX_SLOTS_> slot_stats_;
+    std::atomic<bool> refresh_scheduled_;
+    QTimer refresh_timer_;
+    QElapsedTimer refresh_clock_;
 
+    /**
+     * @brief Append a row for each entry of a slot table, row i is addressed by slot ID i afterwards
+     * @param[in] names: Names of rows, in order of slot IDs
+     */
+    template <size_t N>
+    void append_slots(const std::array<std::string_view, N>& names) {
+        static_assert(N <= MAX_SLOTS_, "too many slots for latest_");
+        for (const auto& name : names) {
+            list_.appendItem(QString::fromUtf8(name.data(), static_cast<qsizetype>(name.size())));
+        }
+    }
+
+    /**
+     * @brief Pass a value from a decoder to the model, called by the I/O thread
+     * @param[in] slot: Slot ID of row, < MAX_SLOTS_
+     * @param[in] value: New value
+     * @param[in] timestamp: Time of reception in ns
+     * @note Only the latest value of a slot per frame reaches the model, all values are counted in the slot statistics
+     */
+    void push_sample(const int slot, const float value, const int64_t timestamp);
+
+    void refresh();
     void update_map();
     void register_model(const QString& modelname);
-    bool parse(const std::string_view& str, const std::regex& regex, int16_t& value) const;
-    bool parse(const std::string_view& str, const std::regex& regex, int16_t& left, int16_t& right) const;
-    bool parse(const std::string_view& str, const std::regex& regex, float& value) const;
-    bool parse(const std::string_view& str, const std::regex& regex, float& value1, float& value2) const;
 
 public:
-    ValueViewer(QQmlApplicationEngine* p_engine);
+    ValueViewer(QQmlApplicationEngine* p_engine, ConnectionManagerBase& connection);
+
+    /**
+     * @return Statistics of telemetry_, to be called by the GUI thread
+     */
+    auto get_telemetry_statistics() const {
+        return telemetry_.get_statistics();
+    }
+
+    /**
+     * @return Statistics of a slot, updated once per frame; to be called by the GUI thread
+     */
+    const SlotStatistics& get_slot_statistics(const size_t slot) const {
+        return slot_stats_[slot];
+    }
 };